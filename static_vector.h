@@ -0,0 +1,861 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#ifndef STATIC_VECTOR_H__DDK
+#define STATIC_VECTOR_H__DDK
+
+#include "vector_short_opt.h"
+
+#include <iterator>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <exception>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+
+namespace opt
+{
+    // Overflow policies decide what static_vector does when the elements would not fit in N.
+    // The default throws std::length_error, leaving the vector as it was.
+    struct throw_on_overflow
+    {
+        static void overflow();
+    };
+
+    // for code built without exceptions, or where running out of room is a bug anyway
+    struct terminate_on_overflow
+    {
+        static void overflow();
+    };
+}
+
+namespace opt
+{
+    namespace detail
+    {
+        // the elements followed by the size, nothing else
+        template<typename T, std::size_t N, typename SizeType>
+        class static_buffer
+        {
+            public:
+                static_buffer();
+
+            protected:
+                T * get_ptr(std::size_t index);
+                T const * get_ptr(std::size_t index) const;
+
+            protected:
+                alignas(T) unsigned char d_array[N * sizeof(T)];
+                SizeType d_size;
+        };
+
+        // copies, moves and destruction are left to the compiler when T is trivially copyable,
+        // so that the static_vector built on top is trivially copyable, too
+        template<typename T, std::size_t N, typename SizeType, bool Trivial = std::is_trivially_copyable<T>::value>
+        class static_storage : public static_buffer<T, N, SizeType>
+        {
+        };
+
+        template<typename T, std::size_t N, typename SizeType>
+        class static_storage<T, N, SizeType, false> : public static_buffer<T, N, SizeType>
+        {
+            public:
+                static_storage();
+                static_storage(static_storage const & other);
+                static_storage(static_storage && other) noexcept(std::is_nothrow_move_constructible<T>::value);
+
+                ~static_storage();
+
+                static_storage & operator=(static_storage const & other);
+                static_storage & operator=(static_storage && other) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value);
+
+            protected:
+                void destroy_from(std::size_t index);
+        };
+    }
+}
+
+namespace opt
+{
+    // Fixed capacity sibling of vector_short_opt: the elements always live in the object, there is
+    // no heap block and no test for one. Running out of room is handed to OverflowPolicy, except
+    // in try_push_back, which tells by its result.
+    template<typename T, std::size_t N, typename OverflowPolicy = throw_on_overflow, typename SizeType = std::size_t>
+    class static_vector : private detail::static_storage<T, N, SizeType>
+    {
+        public:
+            typedef T value_type;
+            typedef T & reference;
+            typedef T * pointer;
+            typedef T const & const_reference;
+            typedef T const * const_pointer;
+            typedef detail::iterator<T> iterator;
+            typedef detail::const_iterator<T> const_iterator;
+            typedef std::reverse_iterator<iterator> reverse_iterator;
+            typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+            typedef std::ptrdiff_t difference_type;
+            typedef std::size_t size_type;
+
+            static size_type const static_capacity = N;
+
+        public:
+            static_vector();
+            explicit static_vector(size_type n, value_type const & val = value_type());
+            template <class InputIterator>
+            static_vector(InputIterator first, InputIterator last);
+
+            iterator begin();
+            const_iterator begin() const;
+            iterator end();
+            const_iterator end() const;
+
+            reverse_iterator rbegin();
+            const_reverse_iterator rbegin() const;
+            reverse_iterator rend();
+            const_reverse_iterator rend() const;
+
+            void resize(size_type n);
+            void resize(size_type n, value_type const & val);
+
+            void reserve(size_type n);
+
+            reference operator[] (size_type n);
+            const_reference operator[] (size_type n) const;
+
+            reference at(size_type n);
+            const_reference at(size_type n) const;
+
+            reference front();
+            const_reference front() const;
+            reference back();
+            const_reference back() const;
+
+            template <class InputIterator>
+            void assign(InputIterator first, InputIterator last);
+            void assign(size_type n, value_type const & val);
+
+            void push_back(value_type const & val);
+            void push_back(value_type && val);
+            bool try_push_back(value_type const & val);
+            bool try_push_back(value_type && val);
+            template <class... Args>
+            reference emplace_back(Args &&... args);
+            void pop_back();
+
+            iterator insert(iterator position, value_type const & val);
+            iterator insert(iterator position, value_type && val);
+            void insert(iterator position, size_type n, value_type const & val);
+            template <class InputIterator>
+            void insert(iterator position, InputIterator first, InputIterator last);
+            template <class... Args>
+            iterator emplace(iterator position, Args &&... args);
+
+            iterator erase(iterator position);
+            iterator erase(iterator first, iterator last);
+
+            void clear();
+
+            void swap(static_vector & other) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value);
+
+            bool empty() const;
+            size_type size() const;
+            size_type capacity() const;
+            size_type max_size() const;
+
+        private:
+            typedef std::allocator<T> element_allocator;
+
+            static_assert(N > 0, "N must be positive");
+            static_assert(std::is_integral<SizeType>::value && std::is_unsigned<SizeType>::value, "SizeType must be an unsigned integral type");
+            static_assert(N <= std::numeric_limits<SizeType>::max(), "N must fit in SizeType");
+
+        private:
+            reference get_ref(size_type index);
+            const_reference get_ref(size_type index) const;
+
+            template <class... Args>
+            void construct(size_type index, Args &&... args);
+            void destroy(size_type index);
+            void destroy_from(size_type index);
+
+            void check_room(size_type n) const;
+
+            template <class InputIterator>
+            void insert_range(size_type index, InputIterator first, InputIterator last, std::true_type);
+            template <class InputIterator>
+            void insert_range(size_type index, InputIterator first, InputIterator last, std::false_type);
+            template <class InputIterator>
+            void insert_range(size_type index, InputIterator first, InputIterator last, std::input_iterator_tag);
+            template <class ForwardIterator>
+            void insert_range(size_type index, ForwardIterator first, ForwardIterator last, std::forward_iterator_tag);
+
+            template <class InputIterator>
+            void assign_range(InputIterator first, InputIterator last, std::true_type);
+            template <class InputIterator>
+            void assign_range(InputIterator first, InputIterator last, std::false_type);
+            template <class InputIterator>
+            void assign_range(InputIterator first, InputIterator last, std::input_iterator_tag);
+            template <class ForwardIterator>
+            void assign_range(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag);
+    };
+
+    template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+    void swap(static_vector<T, N, OverflowPolicy, SizeType> & lhs, static_vector<T, N, OverflowPolicy, SizeType> & rhs) noexcept(noexcept(lhs.swap(rhs)));
+}
+
+
+namespace opt
+{
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+typename static_vector<T, N, OverflowPolicy, SizeType>::size_type const static_vector<T, N, OverflowPolicy, SizeType>::static_capacity;
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline static_vector<T, N, OverflowPolicy, SizeType>::static_vector()
+{
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline static_vector<T, N, OverflowPolicy, SizeType>::static_vector(size_type n, value_type const & val)
+{
+    assign(n, val);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class InputIterator>
+inline static_vector<T, N, OverflowPolicy, SizeType>::static_vector(InputIterator first, InputIterator last)
+{
+    assign(first, last);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::iterator static_vector<T, N, OverflowPolicy, SizeType>::begin()
+{
+    return iterator(this->get_ptr(0));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::const_iterator static_vector<T, N, OverflowPolicy, SizeType>::begin() const
+{
+    return const_iterator(this->get_ptr(0));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::iterator static_vector<T, N, OverflowPolicy, SizeType>::end()
+{
+    return iterator(this->get_ptr(this->d_size));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::const_iterator static_vector<T, N, OverflowPolicy, SizeType>::end() const
+{
+    return const_iterator(this->get_ptr(this->d_size));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::reverse_iterator static_vector<T, N, OverflowPolicy, SizeType>::rbegin()
+{
+    return reverse_iterator(end());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::const_reverse_iterator static_vector<T, N, OverflowPolicy, SizeType>::rbegin() const
+{
+    return const_reverse_iterator(end());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::reverse_iterator static_vector<T, N, OverflowPolicy, SizeType>::rend()
+{
+    return reverse_iterator(begin());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::const_reverse_iterator static_vector<T, N, OverflowPolicy, SizeType>::rend() const
+{
+    return const_reverse_iterator(begin());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::resize(size_type n)
+{
+    check_room(n);
+
+    if (n < this->d_size)
+    {
+        destroy_from(n);
+    }
+    else
+    {
+        for (; this->d_size < n; ++this->d_size)
+        {
+            construct(this->d_size);
+        }
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::resize(size_type n, value_type const & val)
+{
+    check_room(n);
+
+    if (n < this->d_size)
+    {
+        destroy_from(n);
+    }
+    else
+    {
+        // val may refer to one of the elements, which stay where they are
+        for (; this->d_size < n; ++this->d_size)
+        {
+            construct(this->d_size, val);
+        }
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::reserve(size_type n)
+{
+    check_room(n);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::reference static_vector<T, N, OverflowPolicy, SizeType>::operator[](size_type n)
+{
+    return get_ref(n);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::const_reference static_vector<T, N, OverflowPolicy, SizeType>::operator[](size_type n) const
+{
+    return get_ref(n);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::reference static_vector<T, N, OverflowPolicy, SizeType>::at(size_type n)
+{
+    if (n < this->d_size)
+    {
+        return get_ref(n);
+    }
+    else
+    {
+        throw std::out_of_range("");
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::const_reference static_vector<T, N, OverflowPolicy, SizeType>::at(size_type n) const
+{
+    if (n < this->d_size)
+    {
+        return get_ref(n);
+    }
+    else
+    {
+        throw std::out_of_range("");
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::reference static_vector<T, N, OverflowPolicy, SizeType>::front()
+{
+    return get_ref(0);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::const_reference static_vector<T, N, OverflowPolicy, SizeType>::front() const
+{
+    return get_ref(0);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::reference static_vector<T, N, OverflowPolicy, SizeType>::back()
+{
+    return get_ref(this->d_size - 1);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::const_reference static_vector<T, N, OverflowPolicy, SizeType>::back() const
+{
+    return get_ref(this->d_size - 1);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class InputIterator>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::assign(InputIterator first, InputIterator last)
+{
+    assign_range(first, last, typename std::is_integral<InputIterator>::type());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::assign(size_type n, value_type const & val)
+{
+    check_room(n);
+
+    element_allocator alloc;
+
+    detail::assign_fill_in_place(alloc, this->get_ptr(0), this->d_size, n, val);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::push_back(value_type const & val)
+{
+    (void) emplace_back(val);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::push_back(value_type && val)
+{
+    (void) emplace_back(std::move(val));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline bool static_vector<T, N, OverflowPolicy, SizeType>::try_push_back(value_type const & val)
+{
+    if (this->d_size == N)
+    {
+        return false;
+    }
+    else
+    {
+        construct(this->d_size, val);
+
+        ++this->d_size;
+
+        return true;
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline bool static_vector<T, N, OverflowPolicy, SizeType>::try_push_back(value_type && val)
+{
+    if (this->d_size == N)
+    {
+        return false;
+    }
+    else
+    {
+        construct(this->d_size, std::move(val));
+
+        ++this->d_size;
+
+        return true;
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class... Args>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::reference static_vector<T, N, OverflowPolicy, SizeType>::emplace_back(Args &&... args)
+{
+    check_room(this->d_size + 1);
+
+    construct(this->d_size, std::forward<Args>(args)...);
+
+    ++this->d_size;
+
+    return back();
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::pop_back()
+{
+    destroy(--this->d_size);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::iterator static_vector<T, N, OverflowPolicy, SizeType>::insert(iterator position, value_type const & val)
+{
+    return emplace(position, val);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::iterator static_vector<T, N, OverflowPolicy, SizeType>::insert(iterator position, value_type && val)
+{
+    return emplace(position, std::move(val));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::insert(iterator position, size_type n, value_type const & val)
+{
+    size_type const index = position - begin();
+
+    check_room(this->d_size + n);
+
+    if (n != 0)
+    {
+        element_allocator alloc;
+
+        detail::insert_fill_in_place(alloc, this->get_ptr(0), this->d_size, index, n, val);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class InputIterator>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::insert(iterator position, InputIterator first, InputIterator last)
+{
+    insert_range(position - begin(), first, last, typename std::is_integral<InputIterator>::type());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class... Args>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::iterator static_vector<T, N, OverflowPolicy, SizeType>::emplace(iterator position, Args &&... args)
+{
+    size_type const index = position - begin();
+
+    if (index == this->d_size)
+    {
+        (void) emplace_back(std::forward<Args>(args)...);
+    }
+    else
+    {
+        check_room(this->d_size + 1);
+
+        // args may refer to an element that is about to be shifted
+        element_allocator alloc;
+        detail::temporary_value<T, element_allocator> tmp(alloc, std::forward<Args>(args)...);
+
+        detail::insert_shifted(alloc, this->get_ptr(0), this->d_size, index, std::move(tmp.get()));
+    }
+
+    return iterator(this->get_ptr(index));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::iterator static_vector<T, N, OverflowPolicy, SizeType>::erase(iterator position)
+{
+    return erase(position, position + 1);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::iterator static_vector<T, N, OverflowPolicy, SizeType>::erase(iterator first, iterator last)
+{
+    if (first != last)
+    {
+        element_allocator alloc;
+
+        detail::erase_shifted(alloc, this->get_ptr(0), this->d_size, first - begin(), last - first);
+    }
+
+    return first;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::clear()
+{
+    destroy_from(0);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::swap(static_vector & other) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value)
+{
+    if (this == &other)
+    {
+        // do nothing
+    }
+    else
+    {
+        element_allocator alloc;
+
+        detail::swap_elements(alloc, this->get_ptr(0), this->d_size, other.get_ptr(0), other.d_size);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline bool static_vector<T, N, OverflowPolicy, SizeType>::empty() const
+{
+    return this->d_size == 0;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::size_type static_vector<T, N, OverflowPolicy, SizeType>::size() const
+{
+    return this->d_size;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::size_type static_vector<T, N, OverflowPolicy, SizeType>::capacity() const
+{
+    return N;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::size_type static_vector<T, N, OverflowPolicy, SizeType>::max_size() const
+{
+    return N;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::reference static_vector<T, N, OverflowPolicy, SizeType>::get_ref(size_type index)
+{
+    return *this->get_ptr(index);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline typename static_vector<T, N, OverflowPolicy, SizeType>::const_reference static_vector<T, N, OverflowPolicy, SizeType>::get_ref(size_type index) const
+{
+    return *this->get_ptr(index);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class... Args>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::construct(size_type index, Args &&... args)
+{
+    element_allocator alloc;
+
+    std::allocator_traits<element_allocator>::construct(alloc, this->get_ptr(index), std::forward<Args>(args)...);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::destroy(size_type index)
+{
+    element_allocator alloc;
+
+    std::allocator_traits<element_allocator>::destroy(alloc, this->get_ptr(index));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::destroy_from(size_type index)
+{
+    element_allocator alloc;
+
+    detail::destroy_elements(alloc, this->get_ptr(index), this->get_ptr(this->d_size));
+
+    this->d_size = static_cast<SizeType>(index);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::check_room(size_type n) const
+{
+    if (n > N)
+    {
+        OverflowPolicy::overflow();
+
+        // a policy that returns would leave nowhere to put the elements
+        std::terminate();
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class InputIterator>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::insert_range(size_type index, InputIterator first, InputIterator last, std::true_type)
+{
+    // insert(position, 3, 7) deduces InputIterator as int, which means the fill insert
+    insert(iterator(this->get_ptr(index)), static_cast<size_type>(first), static_cast<value_type>(last));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class InputIterator>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::insert_range(size_type index, InputIterator first, InputIterator last, std::false_type)
+{
+    insert_range(index, first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class InputIterator>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::insert_range(size_type index, InputIterator first, InputIterator last, std::input_iterator_tag)
+{
+    // the length is unknown up front, so append and rotate the new elements into place; the vector
+    // is left as it was on overflow
+    size_type const old_size = this->d_size;
+
+    try
+    {
+        for (; first != last; ++first)
+        {
+            check_room(this->d_size + 1);
+
+            construct(this->d_size, *first);
+
+            ++this->d_size;
+        }
+    }
+    catch (...)
+    {
+        destroy_from(old_size);
+
+        throw;
+    }
+
+    (void) std::rotate(this->get_ptr(index), this->get_ptr(old_size), this->get_ptr(this->d_size));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class ForwardIterator>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::insert_range(size_type index, ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+{
+    size_type const count = static_cast<size_type>(std::distance(first, last));
+
+    check_room(this->d_size + count);
+
+    if (count != 0)
+    {
+        element_allocator alloc;
+
+        detail::insert_range_in_place(alloc, this->get_ptr(0), this->d_size, index, first, last, count);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class InputIterator>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::assign_range(InputIterator first, InputIterator last, std::true_type)
+{
+    // assign(3, 7) and static_vector(3, 7) deduce InputIterator as int, which means the fill versions
+    assign(static_cast<size_type>(first), static_cast<value_type>(last));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class InputIterator>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::assign_range(InputIterator first, InputIterator last, std::false_type)
+{
+    assign_range(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class InputIterator>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::assign_range(InputIterator first, InputIterator last, std::input_iterator_tag)
+{
+    clear();
+
+    insert_range(0, first, last, std::input_iterator_tag());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+template <class ForwardIterator>
+inline void static_vector<T, N, OverflowPolicy, SizeType>::assign_range(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+{
+    // measuring the range first means the elements are kept on overflow
+    size_type const n = static_cast<size_type>(std::distance(first, last));
+
+    check_room(n);
+
+    element_allocator alloc;
+
+    detail::assign_in_place(alloc, this->get_ptr(0), this->d_size, first, last, n);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename OverflowPolicy, typename SizeType>
+inline void swap(static_vector<T, N, OverflowPolicy, SizeType> & lhs, static_vector<T, N, OverflowPolicy, SizeType> & rhs) noexcept(noexcept(lhs.swap(rhs)))
+{
+    lhs.swap(rhs);
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void throw_on_overflow::overflow()
+{
+    throw std::length_error("static_vector");
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void terminate_on_overflow::overflow()
+{
+    std::terminate();
+}
+////////////////////////////////////////////////////////////////////////////////
+}
+
+
+namespace opt
+{
+namespace detail
+{
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+inline static_buffer<T, N, SizeType>::static_buffer()
+    : d_size(0)
+{
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+inline T * static_buffer<T, N, SizeType>::get_ptr(std::size_t index)
+{
+    return reinterpret_cast<T *>(d_array) + index;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+inline T const * static_buffer<T, N, SizeType>::get_ptr(std::size_t index) const
+{
+    return reinterpret_cast<T const *>(d_array) + index;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+inline static_storage<T, N, SizeType, false>::static_storage()
+{
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+inline static_storage<T, N, SizeType, false>::static_storage(static_storage const & other)
+{
+    std::allocator<T> alloc;
+
+    (void) copy_elements(alloc, other.get_ptr(0), other.get_ptr(other.d_size), this->get_ptr(0));
+
+    this->d_size = other.d_size;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+inline static_storage<T, N, SizeType, false>::static_storage(static_storage && other) noexcept(std::is_nothrow_move_constructible<T>::value)
+{
+    // other is left empty
+    std::allocator<T> alloc;
+
+    (void) uninitialized_copy_a(alloc, std::make_move_iterator(other.get_ptr(0)), std::make_move_iterator(other.get_ptr(other.d_size)), this->get_ptr(0));
+
+    this->d_size = other.d_size;
+
+    other.destroy_from(0);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+inline static_storage<T, N, SizeType, false>::~static_storage()
+{
+    destroy_from(0);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+inline static_storage<T, N, SizeType, false> & static_storage<T, N, SizeType, false>::operator=(static_storage const & other)
+{
+    if (this != &other)
+    {
+        std::allocator<T> alloc;
+
+        assign_in_place(alloc, this->get_ptr(0), this->d_size, other.get_ptr(0), other.get_ptr(other.d_size), other.d_size);
+    }
+
+    return *this;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+inline static_storage<T, N, SizeType, false> & static_storage<T, N, SizeType, false>::operator=(static_storage && other) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value)
+{
+    if (this != &other)
+    {
+        // other is left empty
+        std::allocator<T> alloc;
+
+        assign_in_place(alloc, this->get_ptr(0), this->d_size, std::make_move_iterator(other.get_ptr(0)), std::make_move_iterator(other.get_ptr(other.d_size)), other.d_size);
+
+        other.destroy_from(0);
+    }
+
+    return *this;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+inline void static_storage<T, N, SizeType, false>::destroy_from(std::size_t index)
+{
+    std::allocator<T> alloc;
+
+    destroy_elements(alloc, this->get_ptr(index), this->get_ptr(this->d_size));
+
+    this->d_size = static_cast<SizeType>(index);
+}
+////////////////////////////////////////////////////////////////////////////////
+}
+}
+
+#endif /* STATIC_VECTOR_H__DDK */
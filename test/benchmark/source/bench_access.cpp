@@ -0,0 +1,82 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "vector_short_opt.h"
+
+#include <vector>
+#include <cstddef> // std::size_t
+
+
+namespace
+{
+    template<std::size_t N>
+    std::vector<opt::vector_short_opt<int, N> > make_vectors(std::size_t count)
+    {
+        std::vector<opt::vector_short_opt<int, N> > vectors(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            // mix inline and spilled vectors so the access paths cannot be predicted
+            std::size_t const size = (i * 7) % (2 * N);
+
+            for (std::size_t j = 0; j < size; ++j)
+            {
+                vectors[i].push_back(static_cast<int>(j));
+            }
+        }
+
+        return vectors;
+    }
+
+    template<std::size_t N>
+    void access_subscript(benchmark::State & state)
+    {
+        std::vector<opt::vector_short_opt<int, N> > const vectors = make_vectors<N>(static_cast<std::size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            int sum = 0;
+
+            for (std::size_t i = 0; i < vectors.size(); ++i)
+            {
+                for (std::size_t j = 0; j < vectors[i].size(); ++j)
+                {
+                    sum += vectors[i][j];
+                }
+            }
+
+            benchmark::DoNotOptimize(sum);
+        }
+    }
+
+    template<std::size_t N>
+    void access_iterator(benchmark::State & state)
+    {
+        typedef opt::vector_short_opt<int, N> vec;
+
+        std::vector<vec> const vectors = make_vectors<N>(static_cast<std::size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            int sum = 0;
+
+            for (std::size_t i = 0; i < vectors.size(); ++i)
+            {
+                for (typename vec::const_iterator j = vectors[i].begin(); j != vectors[i].end(); ++j)
+                {
+                    sum += *j;
+                }
+            }
+
+            benchmark::DoNotOptimize(sum);
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(access_subscript, 4)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(access_subscript, 8)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(access_iterator, 4)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(access_iterator, 8)->Arg(1 << 16);
@@ -0,0 +1,72 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "vector_short_opt.h"
+
+#include <string>
+#include <cstddef> // std::size_t
+
+
+namespace
+{
+    typedef opt::vector_short_opt<std::string, 8> vec8s;
+
+    // long enough to live outside the small string buffer
+    vec8s make_strings(std::size_t size, char fill)
+    {
+        vec8s v;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            v.push_back(std::string(48, fill));
+        }
+
+        return v;
+    }
+
+    template<std::size_t From, std::size_t To>
+    void assign_copy(benchmark::State & state)
+    {
+        vec8s const source = make_strings(From, 'a');
+        vec8s target = make_strings(To, 'b');
+
+        for (auto _ : state)
+        {
+            target = source;
+
+            benchmark::DoNotOptimize(target.begin());
+        }
+    }
+
+    // what the copy assignment used to do: clear() and push_back() every element
+    template<std::size_t From, std::size_t To>
+    void assign_clear_push_back(benchmark::State & state)
+    {
+        vec8s const source = make_strings(From, 'a');
+        vec8s target = make_strings(To, 'b');
+
+        for (auto _ : state)
+        {
+            target.clear();
+
+            for (vec8s::const_iterator i = source.begin(); i != source.end(); ++i)
+            {
+                target.push_back(*i);
+            }
+
+            benchmark::DoNotOptimize(target.begin());
+        }
+    }
+}
+
+#define ASSIGN_BENCHMARK(func) \
+    BENCHMARK_TEMPLATE(func, 4, 4); \
+    BENCHMARK_TEMPLATE(func, 8, 6); \
+    BENCHMARK_TEMPLATE(func, 32, 32); \
+    BENCHMARK_TEMPLATE(func, 24, 64)
+
+ASSIGN_BENCHMARK(assign_copy);
+ASSIGN_BENCHMARK(assign_clear_push_back);
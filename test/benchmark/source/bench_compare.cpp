@@ -0,0 +1,349 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "vector_short_opt.h"
+#include "util_alloc_count.h"
+
+// Boost is optional; without it the comparison runs against std::vector only
+#if defined(__has_include)
+#   if __has_include(<boost/container/small_vector.hpp>)
+#       if defined(__GNUC__) && !defined(__clang__)
+#           pragma GCC diagnostic push
+#           pragma GCC diagnostic ignored "-Wstringop-overread"
+#       endif
+#       include <boost/container/small_vector.hpp>
+#       if defined(__GNUC__) && !defined(__clang__)
+#           pragma GCC diagnostic pop
+#       endif
+#       define BENCH_HAS_BOOST
+#   endif
+#endif
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <new>
+#include <utility> // std::move
+#include <cstddef> // std::size_t
+
+
+namespace
+{
+    // the containers under comparison, all parametrised the same way
+    template<typename T, std::size_t N>
+    struct opt_vso
+    {
+        typedef opt::vector_short_opt<T, N> type;
+    };
+
+    template<typename T, std::size_t N>
+    struct std_vector
+    {
+        typedef std::vector<T> type;
+    };
+
+#ifdef BENCH_HAS_BOOST
+    template<typename T, std::size_t N>
+    struct boost_small_vector
+    {
+        typedef boost::container::small_vector<T, N> type;
+    };
+#endif
+
+    struct pod64
+    {
+        int values[16];
+    };
+
+    static_assert(sizeof(pod64) == 64, "pod64 must be 64 bytes");
+
+    template<typename T>
+    T make(std::size_t i);
+
+    template<>
+    int make<int>(std::size_t i)
+    {
+        return static_cast<int>(i);
+    }
+
+    // short enough for the small string buffer, so allocations/op reflect the container
+    template<>
+    std::string make<std::string>(std::size_t i)
+    {
+        return std::to_string(i);
+    }
+
+    template<>
+    pod64 make<pod64>(std::size_t i)
+    {
+        pod64 p = {};
+
+        p.values[0] = static_cast<int>(i);
+
+        return p;
+    }
+
+    int value_of(int i)
+    {
+        return i;
+    }
+
+    int value_of(std::string const & s)
+    {
+        return static_cast<int>(s.size());
+    }
+
+    int value_of(pod64 const & p)
+    {
+        return p.values[0];
+    }
+
+    template<typename C>
+    C make_container(std::size_t size)
+    {
+        C c;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            c.push_back(make<typename C::value_type>(i));
+        }
+
+        return c;
+    }
+
+    // allocations/op is averaged over the iterations, like the reported time
+    void report_allocations(benchmark::State & state, std::size_t allocations)
+    {
+        state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    }
+
+    // fill an empty container up to the inline capacity and destroy it
+    template<template<typename, std::size_t> class C, typename T, std::size_t N>
+    void compare_push_back(benchmark::State & state)
+    {
+        typedef typename C<T, N>::type container;
+
+        T const value = make<T>(1);
+        std::size_t const a = util::allocations();
+
+        for (auto _ : state)
+        {
+            container c;
+
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                c.push_back(value);
+            }
+
+            benchmark::DoNotOptimize(c.begin());
+        }
+
+        report_allocations(state, util::allocations() - a);
+    }
+
+    // same as push_back, but one element past the inline capacity
+    template<template<typename, std::size_t> class C, typename T, std::size_t N>
+    void compare_spill(benchmark::State & state)
+    {
+        typedef typename C<T, N>::type container;
+
+        T const value = make<T>(1);
+        std::size_t const a = util::allocations();
+
+        for (auto _ : state)
+        {
+            container c;
+
+            for (std::size_t i = 0; i <= N; ++i)
+            {
+                c.push_back(value);
+            }
+
+            benchmark::DoNotOptimize(c.begin());
+        }
+
+        report_allocations(state, util::allocations() - a);
+    }
+
+    template<template<typename, std::size_t> class C, typename T, std::size_t N>
+    void compare_iterate(benchmark::State & state)
+    {
+        typedef typename C<T, N>::type container;
+
+        container const c = make_container<container>(N);
+        std::size_t const a = util::allocations();
+
+        for (auto _ : state)
+        {
+            int sum = 0;
+
+            for (typename container::const_iterator i = c.begin(); i != c.end(); ++i)
+            {
+                sum += value_of(*i);
+            }
+
+            benchmark::DoNotOptimize(sum);
+        }
+
+        report_allocations(state, util::allocations() - a);
+    }
+
+    template<template<typename, std::size_t> class C, typename T, std::size_t N>
+    void compare_copy(benchmark::State & state)
+    {
+        typedef typename C<T, N>::type container;
+
+        container const c = make_container<container>(N);
+        std::size_t const a = util::allocations();
+
+        for (auto _ : state)
+        {
+            container copy(c);
+
+            benchmark::DoNotOptimize(copy.begin());
+        }
+
+        report_allocations(state, util::allocations() - a);
+    }
+
+    // one move construction and one move assignment back per iteration
+    template<template<typename, std::size_t> class C, typename T, std::size_t N>
+    void compare_move(benchmark::State & state)
+    {
+        typedef typename C<T, N>::type container;
+
+        container c = make_container<container>(N);
+        std::size_t const a = util::allocations();
+
+        for (auto _ : state)
+        {
+            container moved(std::move(c));
+
+            benchmark::DoNotOptimize(moved.begin());
+
+            c = std::move(moved);
+        }
+
+        report_allocations(state, util::allocations() - a);
+    }
+
+    // insert at the front, then pop_back, so the size stays at the inline capacity
+    template<template<typename, std::size_t> class C, typename T, std::size_t N>
+    void compare_insert(benchmark::State & state)
+    {
+        typedef typename C<T, N>::type container;
+
+        container c = make_container<container>(N - 1);
+        T const value = make<T>(1);
+        std::size_t const a = util::allocations();
+
+        for (auto _ : state)
+        {
+            c.insert(c.begin(), value);
+
+            benchmark::DoNotOptimize(c.begin());
+
+            c.pop_back();
+        }
+
+        report_allocations(state, util::allocations() - a);
+    }
+
+    // erase the front, then push_back, so the size stays at the inline capacity
+    template<template<typename, std::size_t> class C, typename T, std::size_t N>
+    void compare_erase(benchmark::State & state)
+    {
+        typedef typename C<T, N>::type container;
+
+        container c = make_container<container>(N);
+        T const value = make<T>(1);
+        std::size_t const a = util::allocations();
+
+        for (auto _ : state)
+        {
+            c.erase(c.begin());
+
+            benchmark::DoNotOptimize(c.begin());
+
+            c.push_back(value);
+        }
+
+        report_allocations(state, util::allocations() - a);
+    }
+
+    // destroys a batch of full containers; only the destructor calls are timed
+    template<template<typename, std::size_t> class C, typename T, std::size_t N>
+    void compare_destroy(benchmark::State & state)
+    {
+        typedef typename C<T, N>::type container;
+
+        std::size_t const batch = 64;
+        container const c = make_container<container>(N);
+        std::allocator<container> alloc;
+        container * const storage = alloc.allocate(batch);
+        std::size_t allocations = 0;
+
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+
+            for (std::size_t i = 0; i < batch; ++i)
+            {
+                (void) new (static_cast<void *>(storage + i)) container(c);
+            }
+
+            std::size_t const a = util::allocations();
+
+            state.ResumeTiming();
+
+            for (std::size_t i = 0; i < batch; ++i)
+            {
+                storage[i].~container();
+            }
+
+            benchmark::ClobberMemory();
+
+            allocations += util::allocations() - a;
+        }
+
+        alloc.deallocate(storage, batch);
+
+        report_allocations(state, allocations);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+    }
+}
+
+#ifdef BENCH_HAS_BOOST
+#   define COMPARE_CONTAINERS(func, type, n) \
+        BENCHMARK_TEMPLATE(func, opt_vso, type, n); \
+        BENCHMARK_TEMPLATE(func, boost_small_vector, type, n); \
+        BENCHMARK_TEMPLATE(func, std_vector, type, n)
+#else
+#   define COMPARE_CONTAINERS(func, type, n) \
+        BENCHMARK_TEMPLATE(func, opt_vso, type, n); \
+        BENCHMARK_TEMPLATE(func, std_vector, type, n)
+#endif
+
+#define COMPARE_SIZES(func, type) \
+    COMPARE_CONTAINERS(func, type, 1); \
+    COMPARE_CONTAINERS(func, type, 4); \
+    COMPARE_CONTAINERS(func, type, 8); \
+    COMPARE_CONTAINERS(func, type, 16); \
+    COMPARE_CONTAINERS(func, type, 64)
+
+#define COMPARE_BENCHMARK(func) \
+    COMPARE_SIZES(func, int); \
+    COMPARE_SIZES(func, std::string); \
+    COMPARE_SIZES(func, pod64)
+
+COMPARE_BENCHMARK(compare_push_back);
+COMPARE_BENCHMARK(compare_iterate);
+COMPARE_BENCHMARK(compare_copy);
+COMPARE_BENCHMARK(compare_move);
+COMPARE_BENCHMARK(compare_insert);
+COMPARE_BENCHMARK(compare_erase);
+COMPARE_BENCHMARK(compare_spill);
+COMPARE_BENCHMARK(compare_destroy);
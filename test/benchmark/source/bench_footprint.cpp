@@ -0,0 +1,62 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "vector_short_opt.h"
+
+#include <vector>
+#include <string>
+#include <cstddef> // std::size_t
+
+
+namespace
+{
+    template<typename T, std::size_t N>
+    std::size_t legacy_sizeof()
+    {
+        // inline buffer, size, flag and a whole std::vector side by side
+        struct legacy
+        {
+            char array[N * sizeof(T)];
+            std::size_t size;
+            bool array_used;
+            std::vector<T> vector;
+        };
+
+        return sizeof(legacy);
+    }
+
+    template<typename T, std::size_t N>
+    void footprint(benchmark::State & state)
+    {
+        typedef opt::vector_short_opt<T, N> vec;
+
+        std::size_t const count = static_cast<std::size_t>(state.range(0));
+
+        for (auto _ : state)
+        {
+            std::vector<vec> vectors(count);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                vectors[i].push_back(T());
+            }
+
+            benchmark::DoNotOptimize(vectors.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.counters["sizeof"] = static_cast<double>(sizeof(vec));
+        state.counters["legacy_sizeof"] = static_cast<double>(legacy_sizeof<T, N>());
+        state.counters["MiB"] = static_cast<double>(sizeof(vec) * count) / (1024 * 1024);
+        state.counters["legacy_MiB"] = static_cast<double>(legacy_sizeof<T, N>() * count) / (1024 * 1024);
+    }
+}
+
+BENCHMARK_TEMPLATE(footprint, char, 8)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(footprint, int, 4)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(footprint, int, 16)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(footprint, double, 8)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(footprint, std::string, 4)->Arg(1 << 20);
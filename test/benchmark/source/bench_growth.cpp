@@ -0,0 +1,114 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "vector_short_opt.h"
+
+#include <vector>
+#include <memory>
+#include <cstddef> // std::size_t
+
+
+namespace
+{
+    struct heap_stats
+    {
+        std::size_t allocations;
+        std::size_t live_bytes;
+        std::size_t peak_bytes;
+    };
+
+    heap_stats & stats()
+    {
+        static heap_stats s = {0, 0, 0};
+
+        return s;
+    }
+
+    // forwards to std::allocator and keeps track of the number of blocks and live bytes
+    template<typename T>
+    class counting_allocator
+    {
+        public:
+            typedef T value_type;
+
+            counting_allocator()
+            {
+            }
+
+            template<typename U>
+            counting_allocator(counting_allocator<U> const &)
+            {
+            }
+
+            T * allocate(std::size_t n)
+            {
+                ++stats().allocations;
+                stats().live_bytes += n * sizeof(T);
+
+                if (stats().live_bytes > stats().peak_bytes)
+                {
+                    stats().peak_bytes = stats().live_bytes;
+                }
+
+                return std::allocator<T>().allocate(n);
+            }
+
+            void deallocate(T * ptr, std::size_t n)
+            {
+                stats().live_bytes -= n * sizeof(T);
+
+                std::allocator<T>().deallocate(ptr, n);
+            }
+
+            bool operator==(counting_allocator const &) const
+            {
+                return true;
+            }
+
+            bool operator!=(counting_allocator const &) const
+            {
+                return false;
+            }
+    };
+
+    template<typename GrowthPolicy>
+    void growth_push_back(benchmark::State & state)
+    {
+        typedef opt::vector_short_opt<int, 8, counting_allocator<int>, alignof(int), opt::shrink_never, GrowthPolicy> vec8g;
+
+        std::size_t const count = 4096;
+        std::size_t const max_size = static_cast<std::size_t>(state.range(0));
+
+        stats().allocations = 0;
+        stats().peak_bytes = 0;
+
+        for (auto _ : state)
+        {
+            std::vector<vec8g> vv(count);
+
+            // sizes spread evenly between 0 and max_size, as with many small but some large vectors
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                std::size_t const size = (i * 2654435761u) % (max_size + 1);
+
+                for (std::size_t j = 0; j < size; ++j)
+                {
+                    vv[i].push_back(static_cast<int>(j));
+                }
+            }
+
+            benchmark::DoNotOptimize(vv.data());
+        }
+
+        state.counters["allocs/vector"] = static_cast<double>(stats().allocations) / static_cast<double>(state.iterations() * count);
+        state.counters["peak_heap_KiB"] = static_cast<double>(stats().peak_bytes) / 1024.0;
+    }
+}
+
+BENCHMARK_TEMPLATE(growth_push_back, opt::grow_2x)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(growth_push_back, opt::grow_1_5x)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(growth_push_back, opt::grow_first_spill_2n)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(growth_push_back, opt::grow_size_class)->Arg(16)->Arg(256);
@@ -0,0 +1,171 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "vector_short_opt.h"
+
+#include <memory>
+#include <type_traits>
+#include <cstddef> // std::size_t
+
+
+namespace
+{
+    struct pod
+    {
+        explicit pod(int i)
+            : x(static_cast<float>(i))
+            , y(static_cast<float>(i))
+            , z(static_cast<float>(i))
+        {
+        }
+
+        float x;
+        float y;
+        float z;
+    };
+
+    // same as pod, but opted out of the memcpy path to measure the generic loops
+    struct pod_generic : pod
+    {
+        explicit pod_generic(int i)
+            : pod(i)
+        {
+        }
+    };
+
+    struct handle
+    {
+        explicit handle(int i)
+            : ptr(new int(i))
+        {
+        }
+
+        std::unique_ptr<int> ptr;
+    };
+
+    struct handle_generic : handle
+    {
+        explicit handle_generic(int i)
+            : handle(i)
+        {
+        }
+    };
+}
+
+namespace opt
+{
+    template<>
+    struct is_trivially_relocatable<pod_generic> : std::false_type
+    {
+    };
+
+    template<>
+    struct is_trivially_relocatable<handle> : std::true_type
+    {
+    };
+}
+
+namespace
+{
+    template<typename T, std::size_t N>
+    void relocate_spill(benchmark::State & state)
+    {
+        for (auto _ : state)
+        {
+            opt::vector_short_opt<T, N> v;
+
+            for (std::size_t i = 0; i <= N; ++i)
+            {
+                v.emplace_back(static_cast<int>(i));
+            }
+
+            benchmark::DoNotOptimize(v.begin());
+        }
+    }
+
+    template<typename T, std::size_t N>
+    void relocate_insert_front(benchmark::State & state)
+    {
+        for (auto _ : state)
+        {
+            opt::vector_short_opt<T, N> v;
+
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                v.emplace(v.begin(), static_cast<int>(i));
+            }
+
+            benchmark::DoNotOptimize(v.begin());
+        }
+    }
+
+    template<typename T, std::size_t N>
+    void relocate_erase_front(benchmark::State & state)
+    {
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+
+            opt::vector_short_opt<T, N> v;
+
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                v.emplace_back(static_cast<int>(i));
+            }
+
+            state.ResumeTiming();
+
+            while (!v.empty())
+            {
+                v.erase(v.begin());
+            }
+
+            benchmark::DoNotOptimize(v.begin());
+        }
+    }
+
+    template<typename T, std::size_t N>
+    void relocate_copy(benchmark::State & state)
+    {
+        opt::vector_short_opt<T, N> v;
+
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            v.emplace_back(static_cast<int>(i));
+        }
+
+        for (auto _ : state)
+        {
+            opt::vector_short_opt<T, N> c(v);
+
+            benchmark::DoNotOptimize(c.begin());
+        }
+    }
+}
+
+#define RELOCATE_BENCHMARK(func, type) \
+    BENCHMARK_TEMPLATE(func, type, 4); \
+    BENCHMARK_TEMPLATE(func, type, 8); \
+    BENCHMARK_TEMPLATE(func, type, 16); \
+    BENCHMARK_TEMPLATE(func, type, 64)
+
+RELOCATE_BENCHMARK(relocate_spill, pod);
+RELOCATE_BENCHMARK(relocate_spill, pod_generic);
+RELOCATE_BENCHMARK(relocate_spill, handle);
+RELOCATE_BENCHMARK(relocate_spill, handle_generic);
+
+RELOCATE_BENCHMARK(relocate_insert_front, pod);
+RELOCATE_BENCHMARK(relocate_insert_front, pod_generic);
+RELOCATE_BENCHMARK(relocate_insert_front, handle);
+RELOCATE_BENCHMARK(relocate_insert_front, handle_generic);
+
+RELOCATE_BENCHMARK(relocate_erase_front, pod);
+RELOCATE_BENCHMARK(relocate_erase_front, pod_generic);
+RELOCATE_BENCHMARK(relocate_erase_front, handle);
+RELOCATE_BENCHMARK(relocate_erase_front, handle_generic);
+
+RELOCATE_BENCHMARK(relocate_copy, pod);
+RELOCATE_BENCHMARK(relocate_copy, pod_generic);
@@ -0,0 +1,52 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "vector_short_opt.h"
+
+#include <cstring>
+#include <cstddef> // std::size_t
+
+
+namespace
+{
+    // a decoder that sizes its output first and then overwrites every element
+    template<std::size_t N>
+    void resize_value_init(benchmark::State & state)
+    {
+        std::size_t const size = static_cast<std::size_t>(state.range(0));
+        opt::vector_short_opt<char, N> const input(size, 'x');
+
+        for (auto _ : state)
+        {
+            opt::vector_short_opt<char, N> output;
+
+            output.resize(size);
+            std::memcpy(&output[0], &input[0], size);
+
+            benchmark::DoNotOptimize(output.begin());
+        }
+    }
+
+    template<std::size_t N>
+    void resize_for_overwrite(benchmark::State & state)
+    {
+        std::size_t const size = static_cast<std::size_t>(state.range(0));
+        opt::vector_short_opt<char, N> const input(size, 'x');
+
+        for (auto _ : state)
+        {
+            opt::vector_short_opt<char, N> output;
+
+            output.resize_for_overwrite(size);
+            std::memcpy(&output[0], &input[0], size);
+
+            benchmark::DoNotOptimize(output.begin());
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(resize_value_init, 256)->Arg(64)->Arg(256)->Arg(4096);
+BENCHMARK_TEMPLATE(resize_for_overwrite, 256)->Arg(64)->Arg(256)->Arg(4096);
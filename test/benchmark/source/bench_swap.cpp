@@ -0,0 +1,83 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "vector_short_opt.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstddef> // std::size_t
+
+
+namespace
+{
+    typedef opt::vector_short_opt<int, 8> vec8i;
+
+    // keys are scattered so that std::sort has plenty of swapping to do
+    std::vector<vec8i> make_vectors(std::size_t count, std::size_t size)
+    {
+        std::vector<vec8i> vv(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int const key = static_cast<int>((i * 7919) % count);
+
+            for (std::size_t j = 0; j < size; ++j)
+            {
+                vv[i].push_back(key);
+            }
+        }
+
+        return vv;
+    }
+
+    bool less_front(vec8i const & lhs, vec8i const & rhs)
+    {
+        return lhs.front() < rhs.front();
+    }
+
+    // Size <= 8 keeps every vector inline, larger sizes have them all on the heap
+    template<std::size_t Size>
+    void swap_sort(benchmark::State & state)
+    {
+        std::vector<vec8i> const vv = make_vectors(1024, Size);
+
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+
+            std::vector<vec8i> sv(vv);
+
+            state.ResumeTiming();
+
+            std::sort(sv.begin(), sv.end(), less_front);
+
+            benchmark::DoNotOptimize(sv.data());
+        }
+    }
+
+    template<std::size_t LhsSize, std::size_t RhsSize>
+    void swap_pair(benchmark::State & state)
+    {
+        vec8i lhs(LhsSize, 1);
+        vec8i rhs(RhsSize, 2);
+
+        for (auto _ : state)
+        {
+            swap(lhs, rhs);
+
+            benchmark::DoNotOptimize(lhs.begin());
+            benchmark::DoNotOptimize(rhs.begin());
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(swap_sort, 4);
+BENCHMARK_TEMPLATE(swap_sort, 8);
+BENCHMARK_TEMPLATE(swap_sort, 32);
+
+BENCHMARK_TEMPLATE(swap_pair, 4, 8);
+BENCHMARK_TEMPLATE(swap_pair, 32, 4);
+BENCHMARK_TEMPLATE(swap_pair, 32, 64);
@@ -0,0 +1,7 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN();
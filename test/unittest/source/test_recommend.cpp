@@ -0,0 +1,91 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include "catch/catch.hpp"
+
+#include "recommend.h"
+
+#include "vector_short_opt.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory> // std::allocator
+
+
+namespace
+{
+    struct alignas(32) block
+    {
+        char data[32];
+    };
+
+    char const csv[] =
+        "vector,file,line,inline_capacity,element_size,alignment,objects,spills,shrinks,wasted_bytes,peak_min,peak_max,count\n"
+        "vec4i,a.cpp,10,4,4,4,100,100,0,0,5,5,100\n"
+        "\"vec<block, 2>\",\"b \"\"x\"\".cpp\",20,2,32,32,10,1,0,0,0,0,9\n"
+        "\"vec<block, 2>\",\"b \"\"x\"\".cpp\",20,2,32,32,10,1,0,0,3,4,1\n"
+        "vec8i,c.cpp,30,8,4,4,0,0,0,0,,,\n"
+        "broken,line\n";
+}
+
+TEST_CASE("Recommend", "[recommend]")
+{
+    SECTION("Footprint")
+    {
+        REQUIRE(recommend::footprint(4, sizeof(int), alignof(int)) == sizeof(opt::vector_short_opt<int, 4>));
+        REQUIRE(recommend::footprint(5, sizeof(int), alignof(int)) == sizeof(opt::vector_short_opt<int, 5>));
+        REQUIRE(recommend::footprint(1, sizeof(char), alignof(char)) == sizeof(opt::vector_short_opt<char, 1>));
+        REQUIRE(recommend::footprint(3, sizeof(block), alignof(block)) == sizeof(opt::vector_short_opt<block, 3>));
+        REQUIRE(recommend::footprint(4, sizeof(int), 64) == sizeof(opt::vector_short_opt<int, 4, std::allocator<int>, 64>));
+    }
+
+    SECTION("Read")
+    {
+        std::istringstream is(csv);
+        std::vector<recommend::site> const sites = recommend::read(is);
+
+        REQUIRE(sites.size() == 3);
+
+        REQUIRE(sites[0].vector == "vec4i");
+        REQUIRE(sites[0].inline_capacity == 4);
+        REQUIRE(sites[0].peaks.size() == 1);
+
+        REQUIRE(sites[1].vector == "vec<block, 2>");
+        REQUIRE(sites[1].file == "b \"x\".cpp");
+        REQUIRE(sites[1].element_size == 32);
+        REQUIRE(sites[1].alignment == 32);
+        REQUIRE(sites[1].objects == 10);
+        REQUIRE(sites[1].peaks.size() == 2);
+        REQUIRE(sites[1].peaks[1].max == 4);
+
+        REQUIRE(sites[2].objects == 0);
+        REQUIRE(sites[2].peaks.empty());
+    }
+
+    SECTION("Best capacity")
+    {
+        std::istringstream is(csv);
+        std::vector<recommend::site> const sites = recommend::read(is);
+
+        // every object peaks at 5 elements; 6 takes the same bytes, so the smaller one wins
+        REQUIRE(recommend::best_capacity(sites[0], 64.0, 64) == 5);
+        REQUIRE(recommend::best_capacity(sites[0], 64.0, 4) == 1);
+
+        // with 32-byte aligned elements each inline slot costs a full 32 bytes, so rare spills are cheaper
+        REQUIRE(recommend::best_capacity(sites[1], 64.0, 64) == 1);
+        REQUIRE(recommend::best_capacity(sites[1], 10000.0, 64) == 4);
+    }
+
+    SECTION("Zero capacity")
+    {
+        std::istringstream is(csv);
+        std::vector<recommend::site> const sites = recommend::read(is);
+
+        recommend::cost const c = recommend::evaluate(sites[1], 0);
+
+        REQUIRE(c.spills == Approx(0.1));
+        REQUIRE(c.bytes == Approx(64.0 + 0.1 * 4 * 32));
+    }
+}
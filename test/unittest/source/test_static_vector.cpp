@@ -0,0 +1,408 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include "catch/catch.hpp"
+
+#include "static_vector.h"
+
+#include "util_alloc_count.h"
+#include "util_counted.h"
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iterator> // std::istream_iterator
+#include <memory> // std::unique_ptr
+#include <stdexcept>
+#include <utility> // std::move
+#include <type_traits>
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint32_t
+
+
+typedef opt::static_vector<int, 4> svec4i;
+typedef opt::static_vector<std::string, 4> svec4s;
+typedef opt::static_vector<std::unique_ptr<int>, 4> svec4p;
+typedef opt::static_vector<util::counted<true>, 4> svec4c;
+
+static_assert(std::is_trivially_copyable<svec4i>::value, "static_vector<int, 4> is trivially copyable");
+static_assert(!std::is_trivially_copyable<svec4s>::value, "static_vector<std::string, 4> is not trivially copyable");
+static_assert(std::is_nothrow_move_constructible<svec4p>::value, "static_vector<std::unique_ptr<int>, 4> is movable");
+static_assert(std::is_nothrow_move_constructible<svec4s>::value && std::is_nothrow_move_assignable<svec4s>::value, "svec4s moves must not throw");
+
+static_assert(sizeof(svec4i) == 4 * sizeof(int) + sizeof(std::size_t), "static_vector<int, 4> footprint");
+static_assert(sizeof(opt::static_vector<int, 4, opt::throw_on_overflow, std::uint32_t>) == 4 * sizeof(int) + sizeof(std::uint32_t), "static_vector<int, 4, ..., std::uint32_t> footprint");
+static_assert(sizeof(opt::static_vector<char, 7, opt::throw_on_overflow, unsigned char>) == 8, "static_vector<char, 7, ..., unsigned char> footprint");
+
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Static vector ctors", "[static][ctor]")
+{
+    SECTION("Default")
+    {
+        svec4i const v4;
+
+        REQUIRE(v4.size() == 0);
+        REQUIRE(v4.empty());
+        REQUIRE(v4.capacity() == 4);
+        REQUIRE(v4.max_size() == 4);
+    }
+
+    SECTION("Fill")
+    {
+        svec4s const v4(3, "abc");
+
+        REQUIRE(v4.size() == 3);
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == std::vector<std::string>(3, "abc"));
+    }
+
+    SECTION("Integral range means fill")
+    {
+        svec4i const v4(3, 7);
+
+        REQUIRE(std::vector<int>(v4.begin(), v4.end()) == std::vector<int>(3, 7));
+    }
+
+    SECTION("Forward range")
+    {
+        std::vector<std::string> const vs = {"a", "b", "c", "d"};
+        svec4s const v4(vs.begin(), vs.end());
+
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == vs);
+    }
+
+    SECTION("Input range")
+    {
+        std::istringstream iss("1 2 3");
+        svec4i const v4((std::istream_iterator<int>(iss)), std::istream_iterator<int>());
+
+        REQUIRE(std::vector<int>(v4.begin(), v4.end()) == std::vector<int>({1, 2, 3}));
+    }
+
+    SECTION("Too many")
+    {
+        std::vector<int> const vi(5, 1);
+
+        REQUIRE_THROWS_AS(svec4i(5, 1), std::length_error);
+        REQUIRE_THROWS_AS(svec4i(vi.begin(), vi.end()), std::length_error);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Static vector copy and move", "[static][copy][move]")
+{
+    SECTION("Copy int")
+    {
+        svec4i v4(3, 5);
+        svec4i const c4(v4);
+
+        v4[0] = 1;
+
+        REQUIRE(std::vector<int>(c4.begin(), c4.end()) == std::vector<int>(3, 5));
+    }
+
+    SECTION("Copy std::string")
+    {
+        svec4s v4(2, "abc");
+        svec4s c4(3, "def");
+
+        c4 = v4;
+
+        REQUIRE(std::vector<std::string>(c4.begin(), c4.end()) == std::vector<std::string>(2, "abc"));
+
+        c4 = svec4s(4, "ghi");
+
+        REQUIRE(std::vector<std::string>(c4.begin(), c4.end()) == std::vector<std::string>(4, "ghi"));
+    }
+
+    SECTION("Move std::unique_ptr")
+    {
+        svec4p v4;
+        v4.push_back(std::unique_ptr<int>(new int(1)));
+        v4.push_back(std::unique_ptr<int>(new int(2)));
+
+        svec4p m4(std::move(v4));
+
+        REQUIRE(v4.empty());
+        REQUIRE(m4.size() == 2);
+        REQUIRE(*m4[1] == 2);
+
+        v4.push_back(std::unique_ptr<int>(new int(3)));
+        v4 = std::move(m4);
+
+        REQUIRE(m4.empty());
+        REQUIRE(v4.size() == 2);
+        REQUIRE(*v4[0] == 1);
+    }
+
+    SECTION("Lifetimes")
+    {
+        util::reset_counts();
+
+        {
+            svec4c v4(3, util::counted<true>(1));
+            svec4c c4(v4);
+            svec4c m4(std::move(c4));
+
+            c4 = m4;
+            m4 = std::move(v4);
+        }
+
+        REQUIRE(util::alive() == 0);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Static vector never allocates", "[static][allocations]")
+{
+    std::size_t const before = util::allocations();
+
+    {
+        svec4i v4;
+        v4.push_back(1);
+        v4.insert(v4.begin(), 3, 2);
+        v4.erase(v4.begin());
+        v4.resize(4);
+        svec4i c4(v4);
+        c4.swap(v4);
+    }
+
+    std::size_t const allocations = util::allocations() - before;
+
+    REQUIRE(allocations == 0);
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Static vector push back", "[static][push back]")
+{
+    SECTION("Up to capacity")
+    {
+        svec4i v4;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            v4.push_back(i);
+        }
+
+        REQUIRE(std::vector<int>(v4.begin(), v4.end()) == std::vector<int>({0, 1, 2, 3}));
+        REQUIRE(v4.front() == 0);
+        REQUIRE(v4.back() == 3);
+        REQUIRE_THROWS_AS(v4.push_back(4), std::length_error);
+        REQUIRE_THROWS_AS(v4.emplace_back(4), std::length_error);
+        REQUIRE(v4.size() == 4);
+    }
+
+    SECTION("Try")
+    {
+        svec4s v4;
+        std::string s = "abc";
+
+        REQUIRE(v4.try_push_back(s));
+        REQUIRE(v4.try_push_back(std::string("def")));
+        REQUIRE(v4.try_push_back(s));
+        REQUIRE(v4.try_push_back(std::move(s)));
+        REQUIRE(!v4.try_push_back(std::string("ghi")));
+        REQUIRE(v4.size() == 4);
+        REQUIRE(v4[1] == "def");
+    }
+
+    SECTION("Own element")
+    {
+        svec4s v4(1, "abc");
+
+        v4.push_back(v4.back());
+
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == std::vector<std::string>(2, "abc"));
+    }
+
+    SECTION("Pop back")
+    {
+        svec4s v4(2, "abc");
+
+        v4.pop_back();
+
+        REQUIRE(v4.size() == 1);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Static vector insert", "[static][insert]")
+{
+    std::vector<std::string> const vs = {"a", "b", "c"};
+
+    SECTION("Single")
+    {
+        svec4s v4(vs.begin(), vs.end());
+
+        svec4s::iterator const it = v4.insert(v4.begin() + 1, "x");
+
+        REQUIRE(*it == "x");
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == std::vector<std::string>({"a", "x", "b", "c"}));
+        REQUIRE_THROWS_AS(v4.insert(v4.begin(), "y"), std::length_error);
+        REQUIRE(v4.size() == 4);
+    }
+
+    SECTION("Single own element")
+    {
+        svec4s v4(vs.begin(), vs.end());
+
+        v4.insert(v4.begin(), v4[2]);
+
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == std::vector<std::string>({"c", "a", "b", "c"}));
+    }
+
+    SECTION("Emplace")
+    {
+        svec4s v4(vs.begin(), vs.end() - 1);
+
+        v4.emplace(v4.begin(), 2, 'z');
+        v4.emplace(v4.end(), "end");
+
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == std::vector<std::string>({"zz", "a", "b", "end"}));
+    }
+
+    SECTION("Fill")
+    {
+        svec4s v4(vs.begin(), vs.end() - 1);
+
+        v4.insert(v4.begin() + 1, 2, "x");
+
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == std::vector<std::string>({"a", "x", "x", "b"}));
+        REQUIRE_THROWS_AS(v4.insert(v4.begin(), 1, "y"), std::length_error);
+    }
+
+    SECTION("Fill own element")
+    {
+        svec4s v4(vs.begin(), vs.end());
+        svec4s w4(vs.begin(), vs.end() - 1);
+
+        v4.insert(v4.begin(), 1, v4[1]);
+        w4.insert(w4.begin() + 1, 2, w4[1]);
+
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == std::vector<std::string>({"b", "a", "b", "c"}));
+        REQUIRE(std::vector<std::string>(w4.begin(), w4.end()) == std::vector<std::string>({"a", "b", "b", "b"}));
+    }
+
+    SECTION("Fill shifts the tail once")
+    {
+        svec4c v4;
+        util::counted<true> const val(9);
+
+        v4.emplace_back(0);
+        v4.emplace_back(1);
+        v4.emplace_back(2);
+
+        util::reset_counts();
+
+        v4.insert(v4.begin(), 1, val);
+
+        REQUIRE(util::counts().moves == 3);
+        REQUIRE(util::counts().copies == 1);
+        REQUIRE(v4[0].value() == 9);
+        REQUIRE(v4[3].value() == 2);
+    }
+
+    SECTION("Forward range")
+    {
+        svec4s v4(1, "z");
+
+        v4.insert(v4.begin(), vs.begin(), vs.end());
+
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == std::vector<std::string>({"a", "b", "c", "z"}));
+    }
+
+    SECTION("Input range overflow leaves the vector unchanged")
+    {
+        svec4i v4(2, 9);
+        std::istringstream iss("1 2 3");
+
+        REQUIRE_THROWS_AS(v4.insert(v4.begin(), std::istream_iterator<int>(iss), std::istream_iterator<int>()), std::length_error);
+        REQUIRE(std::vector<int>(v4.begin(), v4.end()) == std::vector<int>(2, 9));
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Static vector erase", "[static][erase]")
+{
+    std::vector<std::string> const vs = {"a", "b", "c", "d"};
+    svec4s v4(vs.begin(), vs.end());
+
+    SECTION("Single")
+    {
+        svec4s::iterator const it = v4.erase(v4.begin() + 1);
+
+        REQUIRE(*it == "c");
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == std::vector<std::string>({"a", "c", "d"}));
+    }
+
+    SECTION("Range")
+    {
+        v4.erase(v4.begin(), v4.begin() + 3);
+
+        REQUIRE(std::vector<std::string>(v4.begin(), v4.end()) == std::vector<std::string>({"d"}));
+    }
+
+    SECTION("Clear")
+    {
+        v4.clear();
+
+        REQUIRE(v4.empty());
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Static vector resize, reserve and at", "[static][resize][reserve][at]")
+{
+    svec4i v4(2, 1);
+
+    v4.resize(4, 2);
+    REQUIRE(std::vector<int>(v4.begin(), v4.end()) == std::vector<int>({1, 1, 2, 2}));
+
+    v4.resize(1);
+    REQUIRE(std::vector<int>(v4.begin(), v4.end()) == std::vector<int>({1}));
+
+    REQUIRE_THROWS_AS(v4.resize(5), std::length_error);
+    REQUIRE_NOTHROW(v4.reserve(4));
+    REQUIRE_THROWS_AS(v4.reserve(5), std::length_error);
+
+    REQUIRE(v4.at(0) == 1);
+    REQUIRE_THROWS_AS(v4.at(1), std::out_of_range);
+
+    v4.assign(3, 4);
+    REQUIRE(std::vector<int>(v4.rbegin(), v4.rend()) == std::vector<int>(3, 4));
+
+    std::vector<std::string> const vs = {"a", "b", "c"};
+    svec4s s4(vs.begin(), vs.end());
+
+    s4.assign(4, s4[2]);
+    REQUIRE(std::vector<std::string>(s4.begin(), s4.end()) == std::vector<std::string>(4, "c"));
+
+    s4[3] = "d";
+    s4.assign(2, s4[3]);
+    REQUIRE(std::vector<std::string>(s4.begin(), s4.end()) == std::vector<std::string>(2, "d"));
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Static vector swap", "[static][swap]")
+{
+    SECTION("int")
+    {
+        svec4i a(1, 1);
+        svec4i b(3, 2);
+
+        swap(a, b);
+
+        REQUIRE(std::vector<int>(a.begin(), a.end()) == std::vector<int>(3, 2));
+        REQUIRE(std::vector<int>(b.begin(), b.end()) == std::vector<int>(1, 1));
+    }
+
+    SECTION("std::string")
+    {
+        svec4s a(1, "a");
+        svec4s b(3, "b");
+
+        a.swap(b);
+
+        REQUIRE(std::vector<std::string>(a.begin(), a.end()) == std::vector<std::string>(3, "b"));
+        REQUIRE(std::vector<std::string>(b.begin(), b.end()) == std::vector<std::string>(1, "a"));
+
+        b.swap(a);
+
+        REQUIRE(std::vector<std::string>(a.begin(), a.end()) == std::vector<std::string>(1, "a"));
+        REQUIRE(std::vector<std::string>(b.begin(), b.end()) == std::vector<std::string>(3, "b"));
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
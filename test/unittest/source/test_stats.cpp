@@ -0,0 +1,185 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include "catch/catch.hpp"
+
+#include "vector_short_opt.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <memory> // std::allocator
+#include <utility> // std::move
+#include <typeinfo>
+
+
+typedef opt::vector_short_opt<int, 4> vec4i;
+typedef opt::vector_short_opt<int, 4, std::allocator<int>, alignof(int), opt::shrink_below<2> > vec4b;
+
+template<typename V>
+opt::detail::stats_totals totals(opt::detail::stats_location location)
+{
+    return opt::detail::stats_find_site(typeid(V), V::static_capacity, sizeof(typename V::value_type), alignof(typename V::value_type), location).totals();
+}
+
+TEST_CASE("Stats", "[opt][stats]")
+{
+    // the vectors below pass the same place explicitly, so that they share a site
+    opt::detail::stats_location const here = opt::detail::stats_location::current();
+    std::allocator<int> const alloc;
+
+    opt::detail::stats_totals const before = totals<vec4i>(here);
+
+    SECTION("Inline")
+    {
+        {
+            vec4i v4(alloc, here);
+
+            v4.push_back(1);
+            v4.push_back(2);
+            v4.push_back(3);
+            v4.pop_back();
+        }
+
+        opt::detail::stats_totals const after = totals<vec4i>(here);
+
+        REQUIRE(after.objects == before.objects + 1);
+        REQUIRE(after.spills == before.spills);
+        REQUIRE(after.wasted_bytes == before.wasted_bytes + 2 * sizeof(int));
+        REQUIRE(after.peaks[3] == before.peaks[3] + 1);
+    }
+
+    SECTION("Spill")
+    {
+        {
+            vec4i v4(alloc, here);
+
+            for (int i = 0; i < 5; ++i)
+            {
+                v4.push_back(i);
+            }
+        }
+
+        opt::detail::stats_totals const after = totals<vec4i>(here);
+
+        REQUIRE(after.objects == before.objects + 1);
+        REQUIRE(after.spills == before.spills + 1);
+        REQUIRE(after.wasted_bytes == before.wasted_bytes + 3 * sizeof(int));
+        REQUIRE(after.peaks[5] == before.peaks[5] + 1);
+    }
+
+    SECTION("Shrink")
+    {
+        {
+            vec4i v4(6, 1, alloc, here);
+
+            v4.resize(2);
+            v4.shrink_to_fit();
+        }
+
+        REQUIRE(totals<vec4i>(here).shrinks == before.shrinks + 1);
+        REQUIRE(totals<vec4i>(here).peaks[6] == before.peaks[6] + 1);
+
+        opt::detail::stats_totals const policy = totals<vec4b>(here);
+
+        {
+            vec4b v4(6, 1, alloc, here);
+
+            v4.resize(3);
+            v4.pop_back();
+        }
+
+        REQUIRE(totals<vec4b>(here).shrinks == policy.shrinks + 1);
+    }
+
+    SECTION("Move")
+    {
+        {
+            vec4i ov4(6, 1, alloc, here);
+            vec4i const mv4(std::move(ov4), here);
+        }
+
+        opt::detail::stats_totals const after = totals<vec4i>(here);
+
+        // the moved-from vector does not count its former elements
+        REQUIRE(after.objects == before.objects + 2);
+        REQUIRE(after.peaks[6] == before.peaks[6] + 1);
+        REQUIRE(after.peaks[0] == before.peaks[0] + 1);
+    }
+
+    SECTION("Large")
+    {
+        {
+            vec4i v4(alloc, here);
+
+            v4.resize(1000);
+        }
+
+        std::size_t const bucket = opt::detail::stats_bucket(1000);
+
+        REQUIRE(opt::detail::stats_bucket_min(bucket) == 512);
+        REQUIRE(opt::detail::stats_bucket_max(bucket) == 1023);
+        REQUIRE(totals<vec4i>(here).peaks[bucket] == before.peaks[bucket] + 1);
+    }
+
+    SECTION("Threads")
+    {
+        std::thread thread([&]()
+        {
+            vec4i v4(5, 1, alloc, here);
+        });
+
+        thread.join();
+
+        opt::detail::stats_totals const after = totals<vec4i>(here);
+
+        REQUIRE(after.objects == before.objects + 1);
+        REQUIRE(after.spills == before.spills + 1);
+    }
+
+    SECTION("Sites")
+    {
+        unsigned const line = __LINE__ + 3;
+
+        {
+            vec4i v4(5, 1);
+            vec4i const cv4(v4);
+        }
+
+        opt::detail::stats_location const first = {__FILE__, line};
+        opt::detail::stats_location const second = {__FILE__, line + 1};
+
+        REQUIRE(totals<vec4i>(first).objects == 1);
+        REQUIRE(totals<vec4i>(first).spills == 1);
+        REQUIRE(totals<vec4i>(second).objects == 1);
+        REQUIRE(totals<vec4i>(second).peaks[5] == 1);
+        REQUIRE(totals<vec4i>(here).objects == before.objects);
+    }
+
+    SECTION("Dump")
+    {
+        {
+            vec4i v4(5, 1, alloc, here);
+        }
+
+        std::string const name = opt::detail::stats_type_name(typeid(vec4i));
+
+        std::ostringstream csv;
+        opt::write_stats_csv(csv);
+
+        std::ostringstream row;
+        row << '"' << name << "\",\"" << here.file << "\"," << here.line << ",4,4,4,";
+
+        REQUIRE(csv.str().find("vector,file,line,inline_capacity,element_size,alignment,objects,spills,shrinks,wasted_bytes,peak_min,peak_max,count\n") == 0);
+        REQUIRE(csv.str().find(row.str()) != std::string::npos);
+        REQUIRE(csv.str().find(",5,5,") != std::string::npos);
+
+        std::ostringstream json;
+        opt::write_stats_json(json);
+
+        REQUIRE(json.str().find("{\"vector\": \"" + name + "\", \"file\": \"" + here.file + "\"") != std::string::npos);
+        REQUIRE(json.str().find("\"element_size\": 4, \"alignment\": 4,") != std::string::npos);
+        REQUIRE(json.str().find("{\"min\": 5, \"max\": 5, \"count\": ") != std::string::npos);
+    }
+}
@@ -7,10 +7,21 @@
 #include "vector_short_opt.h"
 
 #include "util_num_elems.h"
+#include "util_alloc_count.h"
+#include "util_counted.h"
+#include "util_test_allocator.h"
 
+#include <vector>
+#include <algorithm> // std::sort
 #include <string>
+#include <sstream>
+#include <iterator> // std::istream_iterator
+#include <memory> // std::unique_ptr
 #include <stdexcept>
+#include <utility> // std::move
+#include <type_traits>
 #include <cstddef> // std::size_t
+#include <cstdint> // std::uintptr_t, std::uint8_t
 
 
 template<typename T>
@@ -31,6 +42,93 @@ typedef vect<int>::type vecti;
 typedef vec4<std::string>::type vec4s;
 typedef vect<std::string>::type vects;
 
+typedef vec4<std::unique_ptr<int> >::type vec4p;
+
+typedef vec4<util::counted<true> >::type vec4c;
+typedef vec4<util::counted<false> >::type vec4t;
+
+struct handle
+{
+    explicit handle(int value)
+        : ptr(new int(value))
+    {
+    }
+
+    std::unique_ptr<int> ptr;
+};
+
+namespace opt
+{
+    template<>
+    struct is_trivially_relocatable<handle> : std::true_type
+    {
+    };
+}
+
+typedef vec4<handle>::type vec4h;
+
+typedef opt::vector_short_opt<int, 4, util::test_allocator<int> > vec4a;
+typedef opt::vector_short_opt<int, 4, util::test_allocator<int, true> > vec4ap;
+typedef opt::vector_short_opt<util::counted<true>, 4, util::test_allocator<util::counted<true> > > vec4ca;
+
+struct alignas(32) lanes
+{
+    explicit lanes(float value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            v[i] = value;
+        }
+    }
+
+    float v[8];
+};
+
+typedef vec4<lanes>::type vec4l;
+typedef opt::vector_short_opt<float, 8, std::allocator<float>, 64> vec8f64;
+
+static_assert(opt::is_trivially_relocatable<int>::value, "int is trivially relocatable");
+static_assert(!opt::is_trivially_relocatable<std::string>::value, "std::string is not trivially relocatable by default");
+
+
+template<typename T, std::size_t N>
+struct footprint
+{
+    static std::size_t const inline_bytes = N * sizeof(T);
+    static std::size_t const heap_bytes = sizeof(std::size_t);
+    static std::size_t const storage_bytes = inline_bytes > heap_bytes ? inline_bytes : heap_bytes;
+
+    // inline buffer and heap capacity share storage, plus data pointer and size
+    static bool const is_compact = sizeof(opt::vector_short_opt<T, N>) <= storage_bytes + sizeof(T *) + sizeof(std::size_t);
+    // the former layout kept an inline buffer, size, flag and a whole std::vector side by side
+    static bool const is_smaller = sizeof(opt::vector_short_opt<T, N>) < inline_bytes + 2 * sizeof(std::size_t) + sizeof(std::vector<T>);
+};
+
+static_assert(footprint<char, 8>::is_compact && footprint<char, 8>::is_smaller, "vector_short_opt<char, 8> footprint");
+static_assert(footprint<int, 4>::is_compact && footprint<int, 4>::is_smaller, "vector_short_opt<int, 4> footprint");
+static_assert(footprint<int, 16>::is_compact && footprint<int, 16>::is_smaller, "vector_short_opt<int, 16> footprint");
+static_assert(footprint<double, 8>::is_compact && footprint<double, 8>::is_smaller, "vector_short_opt<double, 8> footprint");
+static_assert(footprint<void *, 2>::is_compact && footprint<void *, 2>::is_smaller, "vector_short_opt<void *, 2> footprint");
+static_assert(footprint<std::string, 4>::is_compact && footprint<std::string, 4>::is_smaller, "vector_short_opt<std::string, 4> footprint");
+
+struct alignas(16) quad
+{
+    float v[4];
+};
+
+struct triple
+{
+    char c[3];
+};
+
+static_assert(sizeof(opt::small_vector_for<char>) == 64 && opt::small_vector_for<char>::static_capacity == 48, "small_vector_for<char>");
+static_assert(sizeof(opt::small_vector_for<int>) == 64 && opt::small_vector_for<int>::static_capacity == 12, "small_vector_for<int>");
+static_assert(sizeof(opt::small_vector_for<double>) == 64 && opt::small_vector_for<double>::static_capacity == 6, "small_vector_for<double>");
+static_assert(sizeof(opt::small_vector_for<quad>) == 64 && opt::small_vector_for<quad>::static_capacity == 3, "small_vector_for<quad>");
+static_assert(sizeof(opt::small_vector_for<triple>) <= 64 && opt::small_vector_for<triple>::static_capacity == 16, "small_vector_for<triple>");
+static_assert(sizeof(opt::small_vector_for<std::string>) <= 64, "small_vector_for<std::string>");
+static_assert(sizeof(opt::small_vector_for<int, 128>) == 128 && sizeof(opt::small_vector_for<int, 32>) == 32, "small_vector_for<int, Bytes>");
+
 
 void requireEqual(vec4i const & v4, vecti const & vr)
 {
@@ -58,6 +156,17 @@ void requireEqual(vec4s const & v4, vects const & vr)
     }
 }
 
+template<typename V>
+void requireEqual(V const & v4, vecti const & vr)
+{
+    REQUIRE(v4.size() == vr.size());
+
+    for (typename V::size_type i = 0; i != v4.size(); ++i)
+    {
+        REQUIRE(v4[i] == vr[i]);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 TEST_CASE("Default ctor", "[opt][ctor][default]")
 {
@@ -248,6 +357,40 @@ TEST_CASE("Range ctor", "[opt][ctor][range]")
             requireEqual(v4, vr);
         }
     }
+
+    SECTION("Single allocation")
+    {
+        vecti const vr(100, 5);
+
+        std::size_t const a = util::allocations();
+        vec4i const v4(vr.begin(), vr.end());
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a + 1);
+        REQUIRE(v4.capacity() == vr.size());
+
+        requireEqual(v4, vr);
+    }
+
+    SECTION("Input range")
+    {
+        std::istringstream is("0 1 2 3 4 5");
+
+        vec4i const v4((std::istream_iterator<int>(is)), std::istream_iterator<int>());
+
+        int const arr[] = {0, 1, 2, 3, 4, 5};
+
+        requireEqual(v4, vecti(arr, arr + num_elems(arr)));
+    }
+
+    SECTION("Integral arguments")
+    {
+        vec4i const v4(16, 1);
+
+        REQUIRE(v4.size() == 16);
+
+        requireEqual(v4, vecti(16, 1));
+    }
 }
 ////////////////////////////////////////////////////////////////////////////////
 TEST_CASE("Copy ctor", "[opt][ctor][copy]")
@@ -460,6 +603,350 @@ TEST_CASE("Copy assignment operator", "[opt][operator][copy][assignment]")
             requireEqual(cv4, ovr);
         }
     }
+
+    SECTION("Storage reuse")
+    {
+        std::string const l(40, 'l');
+        std::string const arr[] = {l + "0", l + "1", l + "2", l + "3", l + "4", l + "5", l + "6", l + "7"};
+        std::size_t const s = num_elems(arr);
+
+        SECTION("Inline over inline")
+        {
+            vec4s const ov4(arr, arr + 3);
+            vec4s cv4(arr + 4, arr + 7);
+
+            // the strings are assigned over, so their buffers are reused
+            std::size_t const a = util::allocations();
+            cv4 = ov4;
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+
+            requireEqual(cv4, vects(arr, arr + 3));
+        }
+
+        SECTION("Heap over heap")
+        {
+            vec4s const ov4(arr, arr + 6);
+            vec4s cv4(arr, arr + s);
+
+            std::string const * const p = &cv4[0];
+
+            std::size_t const a = util::allocations();
+            cv4 = ov4;
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(&cv4[0] == p);
+
+            requireEqual(cv4, vects(arr, arr + 6));
+
+            cv4 = vec4s(arr, arr + 8);
+
+            requireEqual(cv4, vects(arr, arr + 8));
+        }
+
+        SECTION("Inline over heap")
+        {
+            vec4s const ov4(arr, arr + 2);
+            vec4s cv4(arr, arr + s);
+
+            std::size_t const d = util::deallocations();
+            cv4 = ov4;
+
+            REQUIRE(util::deallocations() > d);
+            REQUIRE(cv4.capacity() == 4);
+
+            requireEqual(cv4, vects(arr, arr + 2));
+        }
+
+        SECTION("Heap over inline")
+        {
+            vec4i const ov4(vec4i::size_type(16), 3);
+            vec4i cv4(vec4i::size_type(2), 1);
+
+            std::size_t const a = util::allocations();
+            cv4 = ov4;
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a + 1);
+            REQUIRE(cv4.capacity() == 16);
+
+            requireEqual(cv4, vecti(16, 3));
+        }
+
+        SECTION("Throwing copy")
+        {
+            vec4t const ov4(2, util::counted<false>(7));
+            vec4t cv4;
+
+            for (int i = 0; i < 6; ++i)
+            {
+                cv4.push_back(i);
+            }
+
+            util::reset_counts(1);
+
+            REQUIRE_THROWS_AS(cv4 = ov4, std::runtime_error);
+
+            util::reset_counts();
+
+            REQUIRE(cv4.size() == 6);
+            REQUIRE(cv4.capacity() > 4);
+            REQUIRE(cv4[5].value() == 5);
+        }
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+static_assert(std::is_nothrow_move_constructible<vec4i>::value && std::is_nothrow_move_assignable<vec4i>::value, "vec4i moves must not throw");
+static_assert(std::is_nothrow_move_constructible<vec4s>::value && std::is_nothrow_move_assignable<vec4s>::value, "vec4s moves must not throw");
+
+TEST_CASE("Move ctor", "[opt][ctor][move]")
+{
+    SECTION("int")
+    {
+        int const arr[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+        SECTION("Zero-size")
+        {
+            vec4i::size_type const s = 0;
+            vec4i ov4(arr, arr + s);
+            vecti const ovr(arr, arr + s);
+
+            std::size_t const a = util::allocations();
+            vec4i const mv4(std::move(ov4));
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+
+        SECTION("One-size")
+        {
+            vec4i::size_type const s = 1;
+            vec4i ov4(arr, arr + s);
+            vecti const ovr(arr, arr + s);
+
+            std::size_t const a = util::allocations();
+            vec4i const mv4(std::move(ov4));
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+
+        SECTION("Sixteen-size")
+        {
+            vec4i::size_type const s = 16;
+            vec4i ov4(arr, arr + s);
+            vecti const ovr(arr, arr + s);
+
+            std::size_t const a = util::allocations();
+            vec4i const mv4(std::move(ov4));
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+    }
+
+    SECTION("std::string")
+    {
+        std::string const arr[16] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14", "15"};
+
+        SECTION("Zero-size")
+        {
+            vec4s::size_type const s = 0;
+            vec4s ov4(arr, arr + s);
+            vects const ovr(arr, arr + s);
+
+            std::size_t const a = util::allocations();
+            vec4s const mv4(std::move(ov4));
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+
+        SECTION("One-size")
+        {
+            vec4s::size_type const s = 1;
+            vec4s ov4(arr, arr + s);
+            vects const ovr(arr, arr + s);
+
+            std::size_t const a = util::allocations();
+            vec4s const mv4(std::move(ov4));
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+
+        SECTION("Sixteen-size")
+        {
+            vec4s::size_type const s = 16;
+            vec4s ov4(arr, arr + s);
+            vects const ovr(arr, arr + s);
+
+            std::size_t const a = util::allocations();
+            vec4s const mv4(std::move(ov4));
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Move assignment operator", "[opt][operator][move][assignment]")
+{
+    SECTION("int")
+    {
+        int const arr[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+        SECTION("Zero-size")
+        {
+            vec4i::size_type const s = 0;
+            vec4i ov4(arr, arr + s);
+            vecti const ovr(arr, arr + s);
+            vec4i mv4(arr + 2, arr + 5);
+
+            std::size_t const a = util::allocations();
+            mv4 = std::move(ov4);
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+
+        SECTION("One-size")
+        {
+            vec4i::size_type const s = 1;
+            vec4i ov4(arr, arr + s);
+            vecti const ovr(arr, arr + s);
+            vec4i mv4(arr + 2, arr + 5);
+
+            std::size_t const a = util::allocations();
+            mv4 = std::move(ov4);
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+
+        SECTION("Sixteen-size")
+        {
+            vec4i::size_type const s = 16;
+            vec4i ov4(arr, arr + s);
+            vecti const ovr(arr, arr + s);
+            vec4i mv4(arr + 2, arr + 5);
+
+            std::size_t const a = util::allocations();
+            mv4 = std::move(ov4);
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+    }
+
+    SECTION("std::string")
+    {
+        std::string const arr[16] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14", "15"};
+
+        SECTION("Zero-size")
+        {
+            vec4s::size_type const s = 0;
+            vec4s ov4(arr, arr + s);
+            vects const ovr(arr, arr + s);
+            vec4s mv4(arr + 2, arr + 5);
+
+            std::size_t const a = util::allocations();
+            mv4 = std::move(ov4);
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+
+        SECTION("One-size")
+        {
+            vec4s::size_type const s = 1;
+            vec4s ov4(arr, arr + s);
+            vects const ovr(arr, arr + s);
+            vec4s mv4(arr + 2, arr + 5);
+
+            std::size_t const a = util::allocations();
+            mv4 = std::move(ov4);
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+
+        SECTION("Sixteen-size")
+        {
+            vec4s::size_type const s = 16;
+            vec4s ov4(arr, arr + s);
+            vects const ovr(arr, arr + s);
+            vec4s mv4(arr + 2, arr + 5);
+
+            std::size_t const a = util::allocations();
+            mv4 = std::move(ov4);
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(mv4.capacity() >= mv4.size());
+            REQUIRE(mv4.size() == s);
+            REQUIRE(ov4.empty());
+
+            requireEqual(mv4, ovr);
+        }
+    }
 }
 ////////////////////////////////////////////////////////////////////////////////
 TEST_CASE("Begin", "[opt][begin]")
@@ -1015,23 +1502,125 @@ TEST_CASE("Resize", "[opt][resize]")
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-TEST_CASE("Reserve", "[opt][reserve]")
+TEST_CASE("Resize own element", "[opt][resize]")
+{
+    std::string const arr[] = {"0", "1", "2", "3"};
+
+    vec4s v4(arr, arr + 4);
+    vects vr(arr, arr + 4);
+
+    v4.resize(9, v4[1]);
+    vr.resize(9, vr[1]);
+
+    requireEqual(v4, vr);
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Resize for overwrite", "[opt][resize][overwrite]")
 {
     SECTION("int")
     {
-        SECTION("Empty")
-        {
-            vec4i v4;
+        int const arr[] = {0, 1, 2, 3};
 
-            SECTION("To zero")
-            {
-                vec4i::size_type const r = 0;
+        vec4i v4(arr, arr + 2);
 
-                v4.reserve(r);
+        v4.resize_for_overwrite(4);
 
-                REQUIRE(v4.capacity() >= v4.size());
+        REQUIRE(v4.size() == 4);
+        REQUIRE(v4.capacity() == 4);
 
-                REQUIRE(v4.capacity() >= r);
+        v4[2] = 2;
+        v4[3] = 3;
+
+        requireEqual(v4, vecti(arr, arr + 4));
+
+        v4.resize_for_overwrite(1);
+
+        requireEqual(v4, vecti(arr, arr + 1));
+
+        v4.resize_for_overwrite(20);
+
+        REQUIRE(v4.size() == 20);
+        REQUIRE(v4.capacity() >= 20);
+        REQUIRE(v4[0] == 0);
+    }
+
+    SECTION("std::string")
+    {
+        std::string const arr[] = {"0", "1"};
+
+        vec4s v4(arr, arr + 2);
+
+        v4.resize_for_overwrite(6);
+
+        REQUIRE(v4.size() == 6);
+        REQUIRE(v4[1] == "1");
+
+        for (std::size_t i = 2; i < v4.size(); ++i)
+        {
+            REQUIRE(v4[i].empty());
+        }
+    }
+
+    SECTION("Append")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+        vec4i v4(arr, arr + 3);
+
+        vec4i::iterator i = v4.append_for_overwrite(5);
+
+        REQUIRE(v4.size() == 8);
+        REQUIRE(i == v4.begin() + 3);
+
+        std::copy(arr + 3, arr + 8, i);
+
+        requireEqual(v4, vecti(arr, arr + 8));
+
+        std::size_t const a = util::allocations();
+        i = v4.append_for_overwrite(0);
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a);
+        REQUIRE(i == v4.end());
+    }
+
+    SECTION("Growth")
+    {
+        vec4i v4;
+
+        std::size_t const a = util::allocations();
+
+        for (int i = 0; i < 64; ++i)
+        {
+            *v4.append_for_overwrite(1) = i;
+        }
+
+        std::size_t const b = util::allocations();
+
+        // appending one at a time grows geometrically, like push_back
+        REQUIRE(b - a <= 5);
+        REQUIRE(v4.size() == 64);
+        REQUIRE(v4[63] == 63);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Reserve", "[opt][reserve]")
+{
+    SECTION("int")
+    {
+        SECTION("Empty")
+        {
+            vec4i v4;
+
+            SECTION("To zero")
+            {
+                vec4i::size_type const r = 0;
+
+                v4.reserve(r);
+
+                REQUIRE(v4.capacity() >= v4.size());
+
+                REQUIRE(v4.capacity() >= r);
                 REQUIRE(v4.size() == 0);
             }
 
@@ -1168,6 +1757,278 @@ TEST_CASE("Reserve", "[opt][reserve]")
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Shrink to fit", "[opt][shrink to fit]")
+{
+    int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+    SECTION("Inline")
+    {
+        vec4i v4(arr, arr + 3);
+
+        std::size_t const a = util::allocations();
+        v4.shrink_to_fit();
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a);
+        REQUIRE(v4.capacity() == 4);
+
+        requireEqual(v4, vecti(arr, arr + 3));
+    }
+
+    SECTION("Back to inline")
+    {
+        vec4a v4(arr, arr + 16, util::test_allocator<int>(1));
+
+        v4.erase(v4.begin() + 2, v4.end());
+
+        REQUIRE(v4.capacity() == 16);
+        REQUIRE(util::outstanding(1) == 1);
+
+        v4.shrink_to_fit();
+
+        REQUIRE(v4.capacity() == 4);
+        REQUIRE(util::outstanding(1) == 0);
+
+        requireEqual(v4, vecti(arr, arr + 2));
+    }
+
+    SECTION("Exact heap block")
+    {
+        vec4i v4(arr, arr + 16);
+
+        v4.resize(10);
+        v4.shrink_to_fit();
+
+        REQUIRE(v4.capacity() == 10);
+
+        requireEqual(v4, vecti(arr, arr + 10));
+    }
+
+    SECTION("std::string")
+    {
+        std::string const sarr[] = {"0", "1", "2", "3", "4", "5"};
+
+        vec4s v4(sarr, sarr + 6);
+
+        v4.pop_back();
+        v4.pop_back();
+        v4.pop_back();
+
+        REQUIRE(v4.capacity() == 6);
+
+        v4.shrink_to_fit();
+
+        REQUIRE(v4.capacity() == 4);
+
+        requireEqual(v4, vects(sarr, sarr + 3));
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Shrink policy", "[opt][shrink policy]")
+{
+    typedef opt::vector_short_opt<int, 4, util::test_allocator<int>, alignof(int), opt::shrink_below<2> > vec4w;
+
+    int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    std::size_t const s = num_elems(arr);
+
+    SECTION("Never")
+    {
+        vec4a v4(arr, arr + s, util::test_allocator<int>(1));
+
+        v4.clear();
+
+        REQUIRE(v4.capacity() == s);
+        REQUIRE(util::outstanding(1) == 1);
+    }
+
+    SECTION("Pop back")
+    {
+        vec4w v4(arr, arr + s, util::test_allocator<int>(1));
+
+        while (v4.size() > 3)
+        {
+            v4.pop_back();
+        }
+
+        // between the low-water mark and N the heap block is kept
+        REQUIRE(v4.capacity() == s);
+        REQUIRE(util::outstanding(1) == 1);
+
+        v4.pop_back();
+
+        REQUIRE(v4.capacity() == 4);
+        REQUIRE(util::outstanding(1) == 0);
+
+        requireEqual(v4, vecti(arr, arr + 2));
+
+        v4.push_back(2);
+        v4.push_back(3);
+
+        REQUIRE(v4.capacity() == 4);
+        REQUIRE(util::outstanding(1) == 0);
+
+        v4.push_back(4);
+
+        REQUIRE(util::outstanding(1) == 1);
+
+        requireEqual(v4, vecti(arr, arr + 5));
+    }
+
+    SECTION("Erase")
+    {
+        vec4w v4(arr, arr + s, util::test_allocator<int>(1));
+
+        v4.erase(v4.begin(), v4.begin() + 8);
+
+        REQUIRE(v4.capacity() == 4);
+        REQUIRE(util::outstanding(1) == 0);
+
+        requireEqual(v4, vecti(arr + 8, arr + s));
+    }
+
+    SECTION("Erase loop")
+    {
+        vec4w v4(arr, arr + s, util::test_allocator<int>(1));
+        vecti vr;
+
+        // the returned iterator must follow the elements back into the inline buffer
+        for (vec4w::iterator it = v4.begin(); it != v4.end();)
+        {
+            if (*it % 9 == 0)
+            {
+                vr.push_back(*it);
+                ++it;
+            }
+            else
+            {
+                it = v4.erase(it);
+            }
+        }
+
+        REQUIRE(v4.capacity() == 4);
+        REQUIRE(util::outstanding(1) == 0);
+
+        requireEqual(v4, vr);
+        requireEqual(v4, vecti({0, 9}));
+    }
+
+    SECTION("Erase range")
+    {
+        vec4w v4(arr, arr + s, util::test_allocator<int>(1));
+
+        vec4w::iterator const it = v4.erase(v4.begin() + 1, v4.begin() + 9);
+
+        REQUIRE(util::outstanding(1) == 0);
+        REQUIRE(it == v4.begin() + 1);
+        REQUIRE(*it == 9);
+    }
+
+    SECTION("Resize")
+    {
+        vec4w v4(arr, arr + s, util::test_allocator<int>(1));
+
+        v4.resize(1);
+
+        REQUIRE(v4.capacity() == 4);
+        REQUIRE(util::outstanding(1) == 0);
+
+        requireEqual(v4, vecti(arr, arr + 1));
+    }
+
+    SECTION("Clear")
+    {
+        vec4w v4(arr, arr + s, util::test_allocator<int>(1));
+
+        v4.clear();
+
+        REQUIRE(v4.empty());
+        REQUIRE(v4.capacity() == 4);
+        REQUIRE(util::outstanding(1) == 0);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename GrowthPolicy>
+std::vector<std::size_t> capacities(std::size_t count)
+{
+    typedef opt::vector_short_opt<int, 8, std::allocator<int>, alignof(int), opt::shrink_never, GrowthPolicy> vec8g;
+
+    std::vector<std::size_t> result;
+    vec8g v8;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        v8.push_back(static_cast<int>(i));
+
+        if (result.empty() || result.back() != v8.capacity())
+        {
+            result.push_back(v8.capacity());
+        }
+    }
+
+    return result;
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Growth policy", "[opt][growth policy]")
+{
+    SECTION("Default")
+    {
+        std::size_t const expected[] = {8, 16, 32, 64};
+
+        REQUIRE(capacities<opt::grow_2x>(64) == std::vector<std::size_t>(expected, expected + num_elems(expected)));
+
+        opt::vector_short_opt<int, 8> v8(8, 1);
+
+        std::size_t const a = util::allocations();
+
+        for (int i = 0; i < 8; ++i)
+        {
+            v8.push_back(i);
+        }
+
+        std::size_t const b = util::allocations();
+
+        // spilling for nine elements used to allocate exactly nine and reallocate right away
+        REQUIRE(v8.capacity() == 16);
+        REQUIRE(b == a + 1);
+    }
+
+    SECTION("1.5x")
+    {
+        std::size_t const expected[] = {8, 12, 18, 27, 40, 60, 90};
+
+        REQUIRE(capacities<opt::grow_1_5x>(64) == std::vector<std::size_t>(expected, expected + num_elems(expected)));
+    }
+
+    SECTION("First spill to 2N")
+    {
+        std::size_t const expected[] = {8, 16, 24, 36, 54, 81};
+
+        REQUIRE(capacities<opt::grow_first_spill_2n>(64) == std::vector<std::size_t>(expected, expected + num_elems(expected)));
+    }
+
+    SECTION("Size classes")
+    {
+        std::size_t const expected[] = {8, 16, 32, 64};
+
+        REQUIRE(capacities<opt::grow_size_class>(64) == std::vector<std::size_t>(expected, expected + num_elems(expected)));
+
+        REQUIRE(opt::grow_size_class::next_capacity(8, 9, true, 12) == 21);
+        REQUIRE(opt::grow_size_class::next_capacity(21, 22, false, 12) == 42);
+        REQUIRE(opt::grow_size_class::next_capacity(1, 2, true, 1) == 16);
+    }
+
+    SECTION("Bulk insert")
+    {
+        opt::vector_short_opt<int, 8, std::allocator<int>, alignof(int), opt::shrink_never, opt::grow_1_5x> v8(8, 1);
+
+        v8.insert(v8.end(), 20, 2);
+
+        // never less than what the insertion needs
+        REQUIRE(v8.capacity() == 28);
+        REQUIRE(v8.size() == 28);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
 TEST_CASE("Subscript operator", "[opt][operator][subscript]")
 {
     SECTION("int")
@@ -1599,6 +2460,58 @@ TEST_CASE("Range assign", "[opt][assign][range]")
             }
         }
     }
+
+    SECTION("Single allocation")
+    {
+        vecti const vr(100, 5);
+
+        vec4i v4(vec4i::size_type(2), 1);
+
+        std::size_t const a = util::allocations();
+        v4.assign(vr.begin(), vr.end());
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a + 1);
+        REQUIRE(v4.capacity() == vr.size());
+
+        requireEqual(v4, vr);
+
+        std::size_t const c = util::allocations();
+        v4.assign(vr.begin(), vr.begin() + 50);
+        std::size_t const d = util::allocations();
+
+        REQUIRE(d == c);
+
+        requireEqual(v4, vecti(50, 5));
+
+        v4.assign(vr.begin(), vr.begin() + 3);
+
+        REQUIRE(v4.capacity() == 4);
+
+        requireEqual(v4, vecti(3, 5));
+    }
+
+    SECTION("Input range")
+    {
+        std::istringstream is("0 1 2 3 4 5");
+
+        vec4i v4(vec4i::size_type(2), 1);
+
+        v4.assign(std::istream_iterator<int>(is), std::istream_iterator<int>());
+
+        int const arr[] = {0, 1, 2, 3, 4, 5};
+
+        requireEqual(v4, vecti(arr, arr + num_elems(arr)));
+    }
+
+    SECTION("Integral arguments")
+    {
+        vec4i v4;
+
+        v4.assign(3, 7);
+
+        requireEqual(v4, vecti(3, 7));
+    }
 }
 ////////////////////////////////////////////////////////////////////////////////
 TEST_CASE("Fill assign", "[opt][assign][fill]")
@@ -1838,48 +2751,273 @@ TEST_CASE("Push back", "[opt][push back]")
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-TEST_CASE("Pop back", "[opt][pop back]")
+TEST_CASE("Push back rvalue", "[opt][push back][rvalue]")
 {
-    SECTION("int")
+    SECTION("std::string")
     {
-        int const arr[] = {0, 1, 2, 3};
-        std::size_t const s = num_elems(arr);
-
-        vec4i v4(arr, arr + s);
-        vecti vr(arr, arr + s);
+        vec4s v4;
+        vects vr;
 
-        while (!v4.empty())
+        for (int i = 1; i < 7; ++i)
         {
-            v4.pop_back();
-            vr.pop_back();
+            std::string s1(32, static_cast<char>('a' + i));
+            std::string s2(s1);
 
-            REQUIRE(v4.capacity() >= v4.size());
+            std::size_t const a = util::allocations();
+            v4.push_back(std::move(s1));
+            std::size_t const b = util::allocations();
+            vr.push_back(std::move(s2));
 
-            requireEqual(v4, vr);
+            if (v4.size() <= 4)
+            {
+                REQUIRE(b == a);
+            }
         }
+
+        REQUIRE(v4.capacity() >= v4.size());
+
+        requireEqual(v4, vr);
     }
 
-    SECTION("std::string")
+    SECTION("std::unique_ptr")
     {
-        std::string const arr[] = {"0", "1", "2", "3"};
-        std::size_t const s = num_elems(arr);
-
-        vec4s v4(arr, arr + s);
-        vects vr(arr, arr + s);
+        vec4p v4;
 
-        while (!v4.empty())
+        for (int i = 0; i < 6; ++i)
         {
-            v4.pop_back();
-            vr.pop_back();
+            std::unique_ptr<int> p(new int(i));
 
-            REQUIRE(v4.capacity() >= v4.size());
+            v4.push_back(std::move(p));
 
-            requireEqual(v4, vr);
+            REQUIRE(!p);
+        }
+
+        REQUIRE(v4.capacity() >= v4.size());
+        REQUIRE(v4.size() == 6);
+
+        for (int i = 0; i < 6; ++i)
+        {
+            REQUIRE(*v4[i] == i);
         }
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-TEST_CASE("Insert single", "[opt][insert][single]")
+TEST_CASE("Emplace back", "[opt][emplace back]")
+{
+    SECTION("std::string")
+    {
+        vec4s v4;
+        vects vr;
+
+        for (int i = 1; i < 7; ++i)
+        {
+            std::string & r = v4.emplace_back(i, 'x');
+            vr.emplace_back(i, 'x');
+
+            REQUIRE(&r == &v4.back());
+        }
+
+        REQUIRE(v4.capacity() >= v4.size());
+
+        requireEqual(v4, vr);
+    }
+
+    SECTION("std::unique_ptr")
+    {
+        vec4p v4;
+
+        for (int i = 0; i < 6; ++i)
+        {
+            v4.emplace_back(new int(i));
+        }
+
+        REQUIRE(v4.capacity() >= v4.size());
+        REQUIRE(v4.size() == 6);
+
+        for (int i = 0; i < 6; ++i)
+        {
+            REQUIRE(*v4[i] == i);
+        }
+    }
+
+    SECTION("Own element")
+    {
+        std::string const arr[] = {"0", "1", "2", "3"};
+        std::size_t const s = num_elems(arr);
+
+        vec4s v4(arr, arr + s);
+        vects vr(arr, arr + s);
+
+        v4.emplace_back(v4.front());
+        vr.emplace_back(vr.front());
+
+        REQUIRE(v4.capacity() >= v4.size());
+
+        requireEqual(v4, vr);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Spill", "[opt][spill]")
+{
+    int const arr[] = {0, 1, 2, 3};
+    std::size_t const s = num_elems(arr);
+
+    SECTION("Nothrow move")
+    {
+        vec4c v4(arr, arr + s);
+
+        util::reset_counts();
+
+        v4.push_back(4);
+
+        REQUIRE(util::counts().copies == 0);
+        REQUIRE(util::counts().moves >= s);
+        REQUIRE(v4.size() == s + 1);
+
+        for (std::size_t i = 0; i < v4.size(); ++i)
+        {
+            REQUIRE(v4[i].value() == static_cast<int>(i));
+        }
+    }
+
+    SECTION("Throwing move")
+    {
+        vec4t v4(arr, arr + s);
+
+        util::reset_counts();
+
+        v4.push_back(4);
+
+        REQUIRE(util::counts().copies == s);
+        REQUIRE(v4.size() == s + 1);
+
+        for (std::size_t i = 0; i < v4.size(); ++i)
+        {
+            REQUIRE(v4[i].value() == static_cast<int>(i));
+        }
+    }
+
+    SECTION("Throwing copy")
+    {
+        vec4t v4(arr, arr + s);
+
+        util::reset_counts(2);
+
+        REQUIRE_THROWS_AS(v4.push_back(4), std::runtime_error);
+
+        util::reset_counts();
+
+        REQUIRE(v4.size() == s);
+        REQUIRE(v4.capacity() == s);
+
+        for (std::size_t i = 0; i < v4.size(); ++i)
+        {
+            REQUIRE(v4[i].value() == static_cast<int>(i));
+        }
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Trivially relocatable", "[opt][relocatable]")
+{
+    vec4h v4;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        v4.emplace_back(i);
+    }
+
+    SECTION("Insert")
+    {
+        v4.emplace(v4.begin(), 3);
+        v4.emplace(v4.begin() + 2, 4);
+        v4.emplace(v4.begin() + 1, 5);
+
+        int const expected[] = {3, 5, 0, 4, 1, 2};
+
+        REQUIRE(v4.capacity() >= v4.size());
+        REQUIRE(v4.size() == num_elems(expected));
+
+        for (std::size_t i = 0; i < num_elems(expected); ++i)
+        {
+            REQUIRE(*v4[i].ptr == expected[i]);
+        }
+    }
+
+    SECTION("Erase")
+    {
+        v4.emplace_back(3);
+        v4.emplace_back(4);
+
+        v4.erase(v4.begin() + 1);
+        v4.erase(v4.begin());
+        v4.erase(v4.end() - 1);
+
+        int const expected[] = {2, 3};
+
+        REQUIRE(v4.size() == num_elems(expected));
+
+        for (std::size_t i = 0; i < num_elems(expected); ++i)
+        {
+            REQUIRE(*v4[i].ptr == expected[i]);
+        }
+    }
+
+    SECTION("Copy")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5};
+        std::size_t const s = num_elems(arr);
+
+        vec4i const ov4(arr, arr + s);
+        vecti const ovr(arr, arr + s);
+
+        vec4i const cv4(ov4);
+
+        requireEqual(cv4, ovr);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Pop back", "[opt][pop back]")
+{
+    SECTION("int")
+    {
+        int const arr[] = {0, 1, 2, 3};
+        std::size_t const s = num_elems(arr);
+
+        vec4i v4(arr, arr + s);
+        vecti vr(arr, arr + s);
+
+        while (!v4.empty())
+        {
+            v4.pop_back();
+            vr.pop_back();
+
+            REQUIRE(v4.capacity() >= v4.size());
+
+            requireEqual(v4, vr);
+        }
+    }
+
+    SECTION("std::string")
+    {
+        std::string const arr[] = {"0", "1", "2", "3"};
+        std::size_t const s = num_elems(arr);
+
+        vec4s v4(arr, arr + s);
+        vects vr(arr, arr + s);
+
+        while (!v4.empty())
+        {
+            v4.pop_back();
+            vr.pop_back();
+
+            REQUIRE(v4.capacity() >= v4.size());
+
+            requireEqual(v4, vr);
+        }
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Insert single", "[opt][insert][single]")
 {
     SECTION("int")
     {
@@ -1974,106 +3112,112 @@ TEST_CASE("Insert single", "[opt][insert][single]")
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-TEST_CASE("Insert fill", "[opt][insert][fill]")
+TEST_CASE("Emplace", "[opt][emplace]")
 {
-    SECTION("int")
+    SECTION("std::string")
     {
-        SECTION("Empty")
-        {
-            int const v1 = 7;
-            int const v2 = 17;
-
-            std::size_t n = 3;
+        std::string const arr[] = {"0", "1", "2"};
+        std::size_t const s = num_elems(arr);
 
-            vec4i v4;
-            vecti vr;
+        vec4s v4(arr, arr + s);
+        vects vr(arr, arr + s);
 
-            SECTION("To begin")
-            {
-                v4.insert(v4.begin(), n, v1);
-                vr.insert(vr.begin(), n, v1);
+        SECTION("To begin")
+        {
+            vec4s::iterator i = v4.emplace(v4.begin(), 3, 'x');
+            (void) vr.emplace(vr.begin(), 3, 'x');
 
-                REQUIRE(v4.capacity() >= v4.size());
+            REQUIRE(i == v4.begin());
 
-                requireEqual(v4, vr);
+            requireEqual(v4, vr);
 
-                v4.insert(v4.begin(), n, v2);
-                vr.insert(vr.begin(), n, v2);
+            i = v4.emplace(v4.begin(), 4, 'y');
+            (void) vr.emplace(vr.begin(), 4, 'y');
 
-                REQUIRE(v4.capacity() >= v4.size());
+            REQUIRE(v4.capacity() >= v4.size());
+            REQUIRE(i == v4.begin());
 
-                requireEqual(v4, vr);
-            }
+            requireEqual(v4, vr);
+        }
 
-            SECTION("To end")
-            {
-                v4.insert(v4.end(), n, v1);
-                vr.insert(vr.end(), n, v1);
+        SECTION("To middle")
+        {
+            vec4s::iterator i = v4.emplace(v4.begin() + 1, 3, 'x');
+            (void) vr.emplace(vr.begin() + 1, 3, 'x');
 
-                REQUIRE(v4.capacity() >= v4.size());
+            REQUIRE(i == v4.begin() + 1);
 
-                requireEqual(v4, vr);
+            requireEqual(v4, vr);
 
-                v4.insert(v4.end(), n, v2);
-                vr.insert(vr.end(), n, v2);
+            i = v4.emplace(v4.begin() + 2, 4, 'y');
+            (void) vr.emplace(vr.begin() + 2, 4, 'y');
 
-                REQUIRE(v4.capacity() >= v4.size());
+            REQUIRE(v4.capacity() >= v4.size());
+            REQUIRE(i == v4.begin() + 2);
 
-                requireEqual(v4, vr);
-            }
+            requireEqual(v4, vr);
         }
-    }
 
-    SECTION("std::string")
-    {
-        SECTION("Empty")
+        SECTION("To end")
         {
-            std::string const v1 = "7";
-            std::string const v2 = "17";
+            vec4s::iterator i = v4.emplace(v4.end(), 3, 'x');
+            (void) vr.emplace(vr.end(), 3, 'x');
 
-            std::size_t n = 3;
+            REQUIRE(i == v4.end() - 1);
 
-            vec4s v4;
-            vects vr;
+            requireEqual(v4, vr);
 
-            SECTION("To begin")
-            {
-                v4.insert(v4.begin(), n, v1);
-                vr.insert(vr.begin(), n, v1);
+            i = v4.emplace(v4.end(), 4, 'y');
+            (void) vr.emplace(vr.end(), 4, 'y');
 
-                REQUIRE(v4.capacity() >= v4.size());
+            REQUIRE(v4.capacity() >= v4.size());
+            REQUIRE(i == v4.end() - 1);
 
-                requireEqual(v4, vr);
+            requireEqual(v4, vr);
+        }
 
-                v4.insert(v4.begin(), n, v2);
-                vr.insert(vr.begin(), n, v2);
+        SECTION("Own element")
+        {
+            v4.emplace(v4.begin(), v4.back());
+            vr.emplace(vr.begin(), vr.back());
 
-                REQUIRE(v4.capacity() >= v4.size());
+            requireEqual(v4, vr);
 
-                requireEqual(v4, vr);
-            }
+            v4.emplace(v4.begin(), v4.back());
+            vr.emplace(vr.begin(), vr.back());
 
-            SECTION("To end")
-            {
-                v4.insert(v4.end(), n, v1);
-                vr.insert(vr.end(), n, v1);
+            REQUIRE(v4.capacity() >= v4.size());
 
-                REQUIRE(v4.capacity() >= v4.size());
+            requireEqual(v4, vr);
+        }
+    }
 
-                requireEqual(v4, vr);
+    SECTION("std::unique_ptr")
+    {
+        vec4p v4;
 
-                v4.insert(v4.end(), n, v2);
-                vr.insert(vr.end(), n, v2);
+        for (int i = 0; i < 3; ++i)
+        {
+            v4.emplace(v4.begin(), new int(i));
+        }
 
-                REQUIRE(v4.capacity() >= v4.size());
+        v4.insert(v4.begin() + 1, std::unique_ptr<int>(new int(3)));
+        v4.insert(v4.end(), std::unique_ptr<int>(new int(4)));
+        v4.erase(v4.begin());
 
-                requireEqual(v4, vr);
-            }
+        int const expected[] = {3, 1, 0, 4};
+
+        REQUIRE(v4.capacity() >= v4.size());
+        REQUIRE(v4.size() == num_elems(expected));
+
+        for (std::size_t i = 0; i < num_elems(expected); ++i)
+        {
+            REQUIRE(*v4[i] == expected[i]);
         }
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-TEST_CASE("Insert raange", "[opt][insert][range]")
+TEST_CASE("Insert fill", "[opt][insert][fill]")
 {
     SECTION("int")
     {
@@ -2170,21 +3314,362 @@ TEST_CASE("Insert raange", "[opt][insert][range]")
             }
         }
     }
-}
-////////////////////////////////////////////////////////////////////////////////
-TEST_CASE("Erase single", "[opt][erase][single]")
-{
-    SECTION("int")
-    {
-        int const arr[] = {0, 1, 2, 3, 4};
-        std::size_t const s = num_elems(arr);
 
-        vec4i v4(arr, arr + s);
-        vecti vr(arr, arr + s);
+    SECTION("Positions")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5};
 
-        SECTION("Front")
+        for (std::size_t s = 0; s <= num_elems(arr); s += 2)
         {
-            vec4i::iterator i = v4.erase(v4.begin());
+            for (std::size_t n = 0; n <= 7; ++n)
+            {
+                for (std::size_t p = 0; p <= s; ++p)
+                {
+                    vec4i v4(arr, arr + s);
+                    vecti vr(arr, arr + s);
+
+                    v4.insert(v4.begin() + p, n, 9);
+                    vr.insert(vr.begin() + p, n, 9);
+
+                    REQUIRE(v4.capacity() >= v4.size());
+
+                    requireEqual(v4, vr);
+
+                    vec4s s4(v4.size(), "x");
+                    vects sr(vr.size(), "x");
+
+                    s4.insert(s4.begin() + p, n, "y");
+                    sr.insert(sr.begin() + p, n, "y");
+
+                    requireEqual(s4, sr);
+                }
+            }
+        }
+    }
+
+    SECTION("Own element")
+    {
+        std::string const arr[] = {"0", "1", "2", "3"};
+
+        SECTION("Inline")
+        {
+            vec4s v4(arr, arr + 3);
+            vects vr(arr, arr + 3);
+
+            v4.insert(v4.begin(), 1, v4[2]);
+            vr.insert(vr.begin(), 1, vr[2]);
+
+            requireEqual(v4, vr);
+        }
+
+        SECTION("Spill")
+        {
+            vec4s v4(arr, arr + 4);
+            vects vr(arr, arr + 4);
+
+            v4.insert(v4.begin() + 1, 5, v4[3]);
+            vr.insert(vr.begin() + 1, 5, vr[3]);
+
+            requireEqual(v4, vr);
+        }
+    }
+
+    SECTION("Single spill")
+    {
+        int const arr[] = {0, 1, 2};
+
+        vec4c v4(arr, arr + 3);
+        util::counted<true> const val(7);
+
+        util::reset_counts();
+
+        std::size_t const a = util::allocations();
+        v4.insert(v4.begin() + 1, 6, val);
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a + 1);
+        REQUIRE(v4.capacity() == 9);
+        REQUIRE(util::counts().copies == 6);
+        REQUIRE(util::counts().moves == 3);
+        REQUIRE(v4[0].value() == 0);
+        REQUIRE(v4[6].value() == 7);
+        REQUIRE(v4[8].value() == 2);
+    }
+
+    SECTION("Single shift")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+        vec4c v4(arr, arr + 8);
+        util::counted<true> const val(9);
+
+        v4.reserve(16);
+
+        util::reset_counts();
+
+        std::size_t const a = util::allocations();
+        v4.insert(v4.begin() + 2, 3, val);
+        std::size_t const b = util::allocations();
+
+        // val is not in the vector, so it is not copied aside first
+        REQUIRE(b == a);
+        REQUIRE(util::counts().moves == 6);
+        REQUIRE(util::counts().copies == 3);
+        REQUIRE(v4.size() == 11);
+        REQUIRE(v4[4].value() == 9);
+        REQUIRE(v4[5].value() == 2);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Insert raange", "[opt][insert][range]")
+{
+    SECTION("int")
+    {
+        SECTION("Empty")
+        {
+            int const v1 = 7;
+            int const v2 = 17;
+
+            std::size_t n = 3;
+
+            vec4i v4;
+            vecti vr;
+
+            SECTION("To begin")
+            {
+                v4.insert(v4.begin(), n, v1);
+                vr.insert(vr.begin(), n, v1);
+
+                REQUIRE(v4.capacity() >= v4.size());
+
+                requireEqual(v4, vr);
+
+                v4.insert(v4.begin(), n, v2);
+                vr.insert(vr.begin(), n, v2);
+
+                REQUIRE(v4.capacity() >= v4.size());
+
+                requireEqual(v4, vr);
+            }
+
+            SECTION("To end")
+            {
+                v4.insert(v4.end(), n, v1);
+                vr.insert(vr.end(), n, v1);
+
+                REQUIRE(v4.capacity() >= v4.size());
+
+                requireEqual(v4, vr);
+
+                v4.insert(v4.end(), n, v2);
+                vr.insert(vr.end(), n, v2);
+
+                REQUIRE(v4.capacity() >= v4.size());
+
+                requireEqual(v4, vr);
+            }
+        }
+    }
+
+    SECTION("std::string")
+    {
+        SECTION("Empty")
+        {
+            std::string const v1 = "7";
+            std::string const v2 = "17";
+
+            std::size_t n = 3;
+
+            vec4s v4;
+            vects vr;
+
+            SECTION("To begin")
+            {
+                v4.insert(v4.begin(), n, v1);
+                vr.insert(vr.begin(), n, v1);
+
+                REQUIRE(v4.capacity() >= v4.size());
+
+                requireEqual(v4, vr);
+
+                v4.insert(v4.begin(), n, v2);
+                vr.insert(vr.begin(), n, v2);
+
+                REQUIRE(v4.capacity() >= v4.size());
+
+                requireEqual(v4, vr);
+            }
+
+            SECTION("To end")
+            {
+                v4.insert(v4.end(), n, v1);
+                vr.insert(vr.end(), n, v1);
+
+                REQUIRE(v4.capacity() >= v4.size());
+
+                requireEqual(v4, vr);
+
+                v4.insert(v4.end(), n, v2);
+                vr.insert(vr.end(), n, v2);
+
+                REQUIRE(v4.capacity() >= v4.size());
+
+                requireEqual(v4, vr);
+            }
+        }
+    }
+
+    SECTION("Forward range")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        int const ins[] = {20, 21, 22, 23, 24, 25, 26, 27};
+
+        for (std::size_t s = 0; s <= 6; s += 2)
+        {
+            for (std::size_t n = 0; n <= num_elems(ins); ++n)
+            {
+                for (std::size_t p = 0; p <= s; ++p)
+                {
+                    vec4i v4(arr, arr + s);
+                    vecti vr(arr, arr + s);
+
+                    v4.insert(v4.begin() + p, ins, ins + n);
+                    vr.insert(vr.begin() + p, ins, ins + n);
+
+                    REQUIRE(v4.capacity() >= v4.size());
+
+                    requireEqual(v4, vr);
+
+                    vec4s s4;
+                    vects sr;
+                    vects sins;
+
+                    for (std::size_t i = 0; i < s; ++i)
+                    {
+                        s4.push_back(std::to_string(arr[i]));
+                        sr.push_back(std::to_string(arr[i]));
+                    }
+
+                    for (std::size_t i = 0; i < n; ++i)
+                    {
+                        sins.push_back(std::to_string(ins[i]));
+                    }
+
+                    s4.insert(s4.begin() + p, sins.begin(), sins.end());
+                    sr.insert(sr.begin() + p, sins.begin(), sins.end());
+
+                    REQUIRE(s4.capacity() >= s4.size());
+
+                    requireEqual(s4, sr);
+                }
+            }
+        }
+    }
+
+    SECTION("Input range")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5};
+
+        vec4i v4(arr, arr + 3);
+        vecti vr(arr, arr + 3);
+
+        std::istringstream is4("20 21 22 23");
+        std::istringstream isr("20 21 22 23");
+
+        v4.insert(v4.begin() + 1, std::istream_iterator<int>(is4), std::istream_iterator<int>());
+        vr.insert(vr.begin() + 1, std::istream_iterator<int>(isr), std::istream_iterator<int>());
+
+        requireEqual(v4, vr);
+    }
+
+    SECTION("Integral arguments")
+    {
+        vec4i v4;
+        vecti vr;
+
+        v4.insert(v4.begin(), 3, 7);
+        vr.insert(vr.begin(), 3, 7);
+
+        requireEqual(v4, vr);
+    }
+
+    SECTION("Single spill")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+        vec4c v4(arr, arr + 2);
+
+        util::reset_counts();
+
+        std::size_t const a = util::allocations();
+        v4.insert(v4.begin() + 1, arr + 2, arr + 8);
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a + 1);
+        REQUIRE(util::counts().moves == 2);
+        REQUIRE(v4.size() == 8);
+        REQUIRE(v4[0].value() == 0);
+        REQUIRE(v4[1].value() == 2);
+        REQUIRE(v4[6].value() == 7);
+        REQUIRE(v4[7].value() == 1);
+    }
+
+    SECTION("Single shift")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+        std::vector<util::counted<true> > const ins(arr + 4, arr + 6);
+
+        vec4c v4(arr, arr + 4);
+        v4.reserve(16);
+
+        util::reset_counts();
+
+        v4.insert(v4.begin(), ins.begin(), ins.end());
+
+        // the four elements move two slots up once, the inserted ones are copied once
+        REQUIRE(util::counts().moves == 4);
+        REQUIRE(util::counts().copies == 2);
+        REQUIRE(v4.size() == 6);
+        REQUIRE(v4[0].value() == 4);
+        REQUIRE(v4[2].value() == 0);
+        REQUIRE(v4[5].value() == 3);
+    }
+
+    SECTION("Throwing copy")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+        std::vector<util::counted<false> > const ins(arr + 2, arr + 8);
+
+        vec4t v4(arr, arr + 2);
+
+        util::reset_counts(3);
+
+        REQUIRE_THROWS_AS(v4.insert(v4.begin() + 1, ins.begin(), ins.end()), std::runtime_error);
+
+        util::reset_counts();
+
+        REQUIRE(v4.size() == 2);
+        REQUIRE(v4.capacity() == 4);
+        REQUIRE(v4[0].value() == 0);
+        REQUIRE(v4[1].value() == 1);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Erase single", "[opt][erase][single]")
+{
+    SECTION("int")
+    {
+        int const arr[] = {0, 1, 2, 3, 4};
+        std::size_t const s = num_elems(arr);
+
+        vec4i v4(arr, arr + s);
+        vecti vr(arr, arr + s);
+
+        SECTION("Front")
+        {
+            vec4i::iterator i = v4.erase(v4.begin());
             (void) vr.erase(vr.begin());
 
             REQUIRE(v4.capacity() >= v4.size());
@@ -2356,6 +3841,77 @@ TEST_CASE("Erase range", "[opt][erase][range]")
             requireEqual(v4, vr);
         }
     }
+
+    SECTION("Complexity")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+        std::size_t const s = num_elems(arr);
+
+        SECTION("Inline")
+        {
+            vec4t v4(arr, arr + 4);
+
+            util::reset_counts();
+
+            vec4t::iterator i = v4.erase(v4.begin(), v4.begin() + 2);
+
+            REQUIRE(util::counts().moves == 2);
+            REQUIRE(util::counts().copies == 0);
+            REQUIRE(i == v4.begin());
+            REQUIRE(v4.size() == 2);
+            REQUIRE(v4[0].value() == 2);
+            REQUIRE(v4[1].value() == 3);
+        }
+
+        SECTION("Heap")
+        {
+            vec4t v4(arr, arr + s);
+
+            util::reset_counts();
+
+            // every element behind the range moves exactly once
+            vec4t::iterator i = v4.erase(v4.begin() + 3, v4.begin() + 10);
+
+            REQUIRE(util::counts().moves == s - 10);
+            REQUIRE(util::counts().copies == 0);
+            REQUIRE(i == v4.begin() + 3);
+            REQUIRE(v4.size() == s - 7);
+
+            for (std::size_t j = 0; j < v4.size(); ++j)
+            {
+                REQUIRE(v4[j].value() == static_cast<int>(j < 3 ? j : j + 7));
+            }
+        }
+
+        SECTION("Empty range")
+        {
+            vec4t v4(arr, arr + s);
+
+            util::reset_counts();
+
+            (void) v4.erase(v4.begin() + 5, v4.begin() + 5);
+
+            REQUIRE(util::counts().moves == 0);
+            REQUIRE(v4.size() == s);
+        }
+
+        SECTION("Trivially relocatable")
+        {
+            vec4h v4;
+
+            for (int j = 0; j < 8; ++j)
+            {
+                v4.emplace_back(j);
+            }
+
+            (void) v4.erase(v4.begin() + 1, v4.begin() + 6);
+
+            REQUIRE(v4.size() == 3);
+            REQUIRE(*v4[0].ptr == 0);
+            REQUIRE(*v4[1].ptr == 6);
+            REQUIRE(*v4[2].ptr == 7);
+        }
+    }
 }
 ////////////////////////////////////////////////////////////////////////////////
 TEST_CASE("Clear", "[opt][clear]")
@@ -2419,15 +3975,169 @@ TEST_CASE("Clear", "[opt][clear]")
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-TEST_CASE("Empty", "[opt][empty]")
+TEST_CASE("Swap", "[opt][swap]")
 {
     SECTION("int")
     {
-        SECTION("Empty")
+        int const arr[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+        SECTION("Inline with inline")
         {
-            vec4i v4;
+            vec4i lv4(arr, arr + 1);
+            vec4i rv4(arr + 4, arr + 7);
 
-            REQUIRE(v4.empty());
+            std::size_t const a = util::allocations();
+            lv4.swap(rv4);
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+
+            requireEqual(lv4, vecti(arr + 4, arr + 7));
+            requireEqual(rv4, vecti(arr, arr + 1));
+        }
+
+        SECTION("Heap with heap")
+        {
+            vec4i lv4(arr, arr + 16);
+            vec4i rv4(arr + 2, arr + 8);
+
+            int const * const lp = &lv4[0];
+            int const * const rp = &rv4[0];
+
+            std::size_t const a = util::allocations();
+            lv4.swap(rv4);
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(&lv4[0] == rp);
+            REQUIRE(&rv4[0] == lp);
+
+            requireEqual(lv4, vecti(arr + 2, arr + 8));
+            requireEqual(rv4, vecti(arr, arr + 16));
+        }
+
+        SECTION("Heap with inline")
+        {
+            vec4i lv4(arr, arr + 16);
+            vec4i rv4(arr + 4, arr + 6);
+
+            int const * const lp = &lv4[0];
+
+            std::size_t const a = util::allocations();
+            lv4.swap(rv4);
+            std::size_t const b = util::allocations();
+
+            REQUIRE(b == a);
+            REQUIRE(&rv4[0] == lp);
+            REQUIRE(lv4.capacity() == 4);
+
+            requireEqual(lv4, vecti(arr + 4, arr + 6));
+            requireEqual(rv4, vecti(arr, arr + 16));
+        }
+
+        SECTION("Inline with heap")
+        {
+            vec4i lv4;
+            vec4i rv4(arr, arr + 5);
+
+            lv4.swap(rv4);
+
+            REQUIRE(lv4.capacity() >= 5);
+            REQUIRE(rv4.capacity() == 4);
+
+            requireEqual(lv4, vecti(arr, arr + 5));
+            requireEqual(rv4, vecti());
+        }
+
+        SECTION("Self")
+        {
+            vec4i v4(arr, arr + 3);
+
+            v4.swap(v4);
+
+            requireEqual(v4, vecti(arr, arr + 3));
+        }
+
+        SECTION("Free function")
+        {
+            vec4i lv4(arr, arr + 2);
+            vec4i rv4(arr, arr + 9);
+
+            using std::swap;
+
+            swap(lv4, rv4);
+
+            static_assert(noexcept(swap(lv4, rv4)), "swap of int vectors does not throw");
+
+            requireEqual(lv4, vecti(arr, arr + 9));
+            requireEqual(rv4, vecti(arr, arr + 2));
+        }
+    }
+
+    SECTION("std::string")
+    {
+        std::string const arr[] = {"0", "1", "2", "3", "4", "5", "6", "7"};
+
+        SECTION("Inline with inline")
+        {
+            vec4s lv4(arr, arr + 4);
+            vec4s rv4(arr + 6, arr + 7);
+
+            lv4.swap(rv4);
+
+            requireEqual(lv4, vects(arr + 6, arr + 7));
+            requireEqual(rv4, vects(arr, arr + 4));
+
+            lv4.swap(rv4);
+
+            requireEqual(lv4, vects(arr, arr + 4));
+            requireEqual(rv4, vects(arr + 6, arr + 7));
+        }
+
+        SECTION("Heap with inline")
+        {
+            vec4s lv4(arr, arr + 8);
+            vec4s rv4(arr + 1, arr + 3);
+
+            lv4.swap(rv4);
+
+            requireEqual(lv4, vects(arr + 1, arr + 3));
+            requireEqual(rv4, vects(arr, arr + 8));
+
+            rv4.swap(lv4);
+
+            requireEqual(lv4, vects(arr, arr + 8));
+            requireEqual(rv4, vects(arr + 1, arr + 3));
+        }
+
+        SECTION("Sort")
+        {
+            std::vector<vec4s> vv;
+
+            for (int i = 7; i >= 0; --i)
+            {
+                vv.push_back(vec4s(arr, arr + i));
+            }
+
+            std::sort(vv.begin(), vv.end(), [](vec4s const & lhs, vec4s const & rhs) { return lhs.size() < rhs.size(); });
+
+            for (std::size_t i = 0; i < vv.size(); ++i)
+            {
+                requireEqual(vv[i], vects(arr, arr + i));
+            }
+        }
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Empty", "[opt][empty]")
+{
+    SECTION("int")
+    {
+        SECTION("Empty")
+        {
+            vec4i v4;
+
+            REQUIRE(v4.empty());
         }
 
         SECTION("Non-empty")
@@ -2587,6 +4297,104 @@ TEST_CASE("Max size", "[opt][max size]")
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename SizeType>
+struct sized
+{
+    typedef opt::vector_short_opt<T, N, std::allocator<T>, alignof(T), opt::shrink_never, opt::grow_2x, SizeType> type;
+};
+
+static_assert(sizeof(sized<std::uint16_t, 3, std::uint16_t>::type) == 16, "vector_short_opt<uint16_t, 3> with uint16_t size");
+static_assert(sizeof(sized<std::uint32_t, 3, std::uint16_t>::type) == 24, "vector_short_opt<uint32_t, 3> with uint16_t size");
+static_assert(sizeof(sized<std::uint32_t, 3, std::uint16_t>::type) < sizeof(opt::vector_short_opt<std::uint32_t, 3>), "a smaller SizeType shrinks the object");
+static_assert(sizeof(sized<char, 6, std::uint8_t>::type) == 16, "vector_short_opt<char, 6> with uint8_t size");
+
+TEST_CASE("Size type", "[opt][size type]")
+{
+    typedef sized<int, 4, std::uint8_t>::type vec4b;
+
+    REQUIRE(vec4b().max_size() == 255);
+
+    SECTION("Push back")
+    {
+        vec4b v4;
+
+        for (int i = 0; i < 255; ++i)
+        {
+            v4.push_back(i);
+        }
+
+        REQUIRE(v4.size() == 255);
+        REQUIRE(v4.capacity() == 255);
+        REQUIRE_THROWS_AS(v4.push_back(255), std::length_error);
+        REQUIRE(v4.size() == 255);
+        REQUIRE(v4[254] == 254);
+    }
+
+    SECTION("Reserve")
+    {
+        vec4b v4(vec4b::size_type(3), 1);
+
+        v4.reserve(255);
+
+        REQUIRE(v4.capacity() == 255);
+        REQUIRE_THROWS_AS(v4.reserve(256), std::length_error);
+        REQUIRE(v4.size() == 3);
+    }
+
+    SECTION("Insert")
+    {
+        vec4b v4(vec4b::size_type(250), 1);
+
+        REQUIRE_THROWS_AS(v4.insert(v4.begin(), 6, 2), std::length_error);
+
+        std::vector<int> const vr(6, 2);
+
+        REQUIRE_THROWS_AS(v4.insert(v4.begin(), vr.begin(), vr.end()), std::length_error);
+        REQUIRE(v4.size() == 250);
+
+        v4.insert(v4.begin(), 5, 2);
+
+        REQUIRE(v4.size() == 255);
+        REQUIRE(v4[0] == 2);
+        REQUIRE(v4[5] == 1);
+    }
+
+    SECTION("Assign")
+    {
+        std::vector<int> const vr(300, 1);
+
+        vec4b v4;
+
+        REQUIRE_THROWS_AS(v4.assign(vr.begin(), vr.end()), std::length_error);
+        REQUIRE_THROWS_AS(v4.assign(300, 1), std::length_error);
+        REQUIRE(v4.empty());
+
+        v4.assign(vr.begin(), vr.begin() + 200);
+
+        REQUIRE(v4.size() == 200);
+    }
+
+    SECTION("Other operations")
+    {
+        int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+        vec4b v4(arr, arr + 10);
+        vec4b c4(v4);
+        vec4b m4(std::move(c4));
+
+        m4.erase(m4.begin() + 2, m4.begin() + 4);
+        m4.resize(12);
+        m4.swap(v4);
+        c4 = v4;
+        c4.shrink_to_fit();
+
+        REQUIRE(v4.size() == 12);
+        REQUIRE(m4.size() == 10);
+        REQUIRE(c4.capacity() == 12);
+        REQUIRE(c4[2] == 4);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
 TEST_CASE("Get allocator", "[opt][get allocator]")
 {
     SECTION("int")
@@ -2604,3 +4412,536 @@ TEST_CASE("Get allocator", "[opt][get allocator]")
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
+template<std::size_t Align, typename T>
+bool is_aligned(T const * ptr)
+{
+    return reinterpret_cast<std::uintptr_t>(ptr) % Align == 0;
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Alignment", "[opt][alignment]")
+{
+    static_assert(alignof(vec4l) >= alignof(lanes), "vector_short_opt<lanes, 4> alignment");
+    static_assert(alignof(vec8f64) == 64, "vector_short_opt<float, 8, Alloc, 64> alignment");
+    static_assert(alignof(opt::vector_short_opt<char, 8>) == alignof(char *), "extra alignment is opt-in");
+
+    SECTION("Over-aligned type")
+    {
+        vec4l v4[3];
+
+        for (std::size_t i = 0; i < num_elems(v4); ++i)
+        {
+            v4[i].push_back(lanes(0.5f));
+            v4[i].emplace_back(1.5f);
+
+            REQUIRE(is_aligned<alignof(lanes)>(&v4[i][0]));
+            REQUIRE(is_aligned<alignof(lanes)>(&v4[i][1]));
+            REQUIRE(v4[i][1].v[7] == 1.5f);
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            v4[0].emplace_back(2.5f);
+        }
+
+        REQUIRE(v4[0].size() == 6);
+        REQUIRE(is_aligned<alignof(lanes)>(&v4[0][0]));
+        REQUIRE(v4[0][0].v[0] == 0.5f);
+        REQUIRE(v4[0][5].v[0] == 2.5f);
+    }
+
+    SECTION("Double")
+    {
+        struct
+        {
+            char c;
+            opt::vector_short_opt<double, 3> v;
+        } s;
+
+        s.v.push_back(1.0);
+
+        REQUIRE(is_aligned<alignof(double)>(&s.v[0]));
+    }
+
+    SECTION("Extra alignment")
+    {
+        vec8f64 v8[3];
+
+        for (std::size_t i = 0; i < num_elems(v8); ++i)
+        {
+            v8[i].assign(8, 1.0f);
+
+            REQUIRE(is_aligned<64>(&v8[i][0]));
+        }
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Allocator", "[opt][allocator]")
+{
+    int const arr[] = {0, 1, 2, 3, 4, 5, 6, 7};
+    std::size_t const s = num_elems(arr);
+
+    vecti const vr(arr, arr + s);
+
+    SECTION("Spill")
+    {
+        {
+            vec4a v4(util::test_allocator<int>(1));
+
+            for (std::size_t i = 0; i < s; ++i)
+            {
+                v4.push_back(arr[i]);
+
+                REQUIRE(util::outstanding(1) == (i < 4 ? 0 : 1));
+            }
+
+            REQUIRE(v4.get_allocator().id() == 1);
+
+            requireEqual(v4, vr);
+        }
+
+        REQUIRE(util::outstanding(1) == 0);
+    }
+
+    SECTION("Copy ctor")
+    {
+        {
+            vec4a const ov4(arr, arr + s, util::test_allocator<int>(1));
+            vec4a const cv4(ov4);
+
+            REQUIRE(cv4.get_allocator().id() == 1);
+            REQUIRE(util::outstanding(1) == 2);
+        }
+
+        REQUIRE(util::outstanding(1) == 0);
+    }
+
+    SECTION("Move ctor")
+    {
+        {
+            vec4a ov4(arr, arr + s, util::test_allocator<int>(1));
+            vec4a const mv4(std::move(ov4));
+
+            REQUIRE(mv4.get_allocator().id() == 1);
+            REQUIRE(mv4.size() == s);
+            REQUIRE(util::outstanding(1) == 1);
+        }
+
+        REQUIRE(util::outstanding(1) == 0);
+    }
+
+    SECTION("Copy assignment")
+    {
+        SECTION("Propagating")
+        {
+            {
+                vec4ap const ov4(arr, arr + s, util::test_allocator<int, true>(1));
+                vec4ap cv4(arr, arr + s, util::test_allocator<int, true>(2));
+
+                cv4 = ov4;
+
+                REQUIRE(cv4.get_allocator().id() == 1);
+                REQUIRE(cv4.size() == s);
+                REQUIRE(util::outstanding(2) == 0);
+            }
+
+            REQUIRE(util::outstanding(1) == 0);
+        }
+
+        SECTION("Non-propagating")
+        {
+            {
+                vec4a const ov4(arr, arr + s, util::test_allocator<int>(1));
+                vec4a cv4(arr, arr + 2, util::test_allocator<int>(2));
+
+                cv4 = ov4;
+
+                REQUIRE(cv4.get_allocator().id() == 2);
+                REQUIRE(cv4.size() == s);
+                REQUIRE(util::outstanding(2) == 1);
+            }
+
+            REQUIRE(util::outstanding(1) == 0);
+            REQUIRE(util::outstanding(2) == 0);
+        }
+    }
+
+    SECTION("Move assignment")
+    {
+        SECTION("Propagating")
+        {
+            {
+                vec4ap ov4(arr, arr + s, util::test_allocator<int, true>(1));
+                vec4ap mv4(arr, arr + s, util::test_allocator<int, true>(2));
+
+                mv4 = std::move(ov4);
+
+                REQUIRE(mv4.get_allocator().id() == 1);
+                REQUIRE(mv4.size() == s);
+                REQUIRE(ov4.empty());
+                REQUIRE(util::outstanding(1) == 1);
+                REQUIRE(util::outstanding(2) == 0);
+            }
+
+            REQUIRE(util::outstanding(1) == 0);
+        }
+
+        SECTION("Non-propagating")
+        {
+            {
+                vec4a ov4(arr, arr + s, util::test_allocator<int>(1));
+                vec4a mv4(util::test_allocator<int>(2));
+
+                mv4 = std::move(ov4);
+
+                REQUIRE(mv4.get_allocator().id() == 2);
+                REQUIRE(mv4.size() == s);
+                REQUIRE(ov4.empty());
+                REQUIRE(util::outstanding(2) == 1);
+            }
+
+            REQUIRE(util::outstanding(1) == 0);
+            REQUIRE(util::outstanding(2) == 0);
+        }
+    }
+
+    SECTION("Swap")
+    {
+        SECTION("Propagating")
+        {
+            {
+                vec4ap lv4(arr, arr + s, util::test_allocator<int, true>(1));
+                vec4ap rv4(arr, arr + 2, util::test_allocator<int, true>(2));
+
+                swap(lv4, rv4);
+
+                REQUIRE(lv4.get_allocator().id() == 2);
+                REQUIRE(rv4.get_allocator().id() == 1);
+                REQUIRE(lv4.size() == 2);
+                REQUIRE(rv4.size() == s);
+                REQUIRE(util::outstanding(1) == 1);
+                REQUIRE(util::outstanding(2) == 0);
+            }
+
+            REQUIRE(util::outstanding(1) == 0);
+        }
+
+        SECTION("Non-propagating")
+        {
+            {
+                vec4a lv4(arr, arr + s, util::test_allocator<int>(1));
+                vec4a rv4(arr, arr + s, util::test_allocator<int>(1));
+
+                swap(lv4, rv4);
+
+                REQUIRE(lv4.get_allocator().id() == 1);
+                REQUIRE(rv4.get_allocator().id() == 1);
+                REQUIRE(util::outstanding(1) == 2);
+            }
+
+            REQUIRE(util::outstanding(1) == 0);
+        }
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Allocations", "[opt][allocations]")
+{
+    typedef util::counted<true> elem;
+
+    elem const arr[] = {0, 1, 2, 3, 4, 5, 6, 7};
+    std::size_t const s = num_elems(arr);
+
+    util::test_allocator<elem> const alloc(3);
+
+    util::reset_allocations(3);
+    util::reset_counts();
+
+    SECTION("Inline")
+    {
+        std::size_t const a = util::allocations();
+
+        {
+            vec4ca v4(alloc);
+
+            v4.push_back(arr[0]);
+            v4.emplace_back(1);
+            v4.insert(v4.begin(), arr[2]);
+            v4.resize(4);
+            v4.erase(v4.begin());
+            v4.assign(arr, arr + 4);
+
+            vec4ca cv4(v4);
+            vec4ca mv4(std::move(cv4));
+
+            mv4 = v4;
+            mv4.swap(v4);
+            v4.clear();
+            v4.shrink_to_fit();
+        }
+
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a);
+        REQUIRE(util::allocations(3) == 0);
+        REQUIRE(util::alive() == 0);
+    }
+
+    SECTION("Spill")
+    {
+        {
+            vec4ca v4(alloc);
+
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                v4.push_back(arr[i]);
+            }
+
+            REQUIRE(util::allocations(3) == 0);
+
+            v4.push_back(arr[4]);
+
+            // the new element is copied straight into the heap block and the four old ones relocated
+            REQUIRE(util::allocations(3) == 1);
+            REQUIRE(util::counts().moves == 4);
+            REQUIRE(util::counts().copies == 5);
+
+            while (v4.size() != v4.capacity())
+            {
+                v4.push_back(arr[v4.size() % s]);
+            }
+
+            REQUIRE(util::allocations(3) == 1);
+            REQUIRE(util::outstanding(3) == 1);
+        }
+
+        REQUIRE(util::outstanding(3) == 0);
+        REQUIRE(util::alive() == 0);
+    }
+
+    SECTION("Move ctor")
+    {
+        vec4ca ov4(arr, arr + s, alloc);
+
+        util::reset_allocations(3);
+        util::reset_counts();
+
+        vec4ca const mv4(std::move(ov4));
+
+        REQUIRE(util::allocations(3) == 0);
+        REQUIRE(util::counts().constructions == 0);
+        REQUIRE(mv4.size() == s);
+    }
+
+    SECTION("Move assignment")
+    {
+        vec4ca ov4(arr, arr + s, alloc);
+        vec4ca mv4(arr, arr + s, alloc);
+
+        util::reset_allocations(3);
+        util::reset_counts();
+
+        mv4 = std::move(ov4);
+
+        REQUIRE(util::allocations(3) == 0);
+        REQUIRE(util::outstanding(3) == 1);
+        REQUIRE(util::counts().constructions == 0);
+        REQUIRE(util::counts().destructions == s);
+        REQUIRE(mv4.size() == s);
+    }
+
+    SECTION("Copy ctor")
+    {
+        vec4ca const ov4(arr, arr + s, alloc);
+
+        REQUIRE(util::allocations(3) == 1);
+
+        vec4ca const cv4(ov4);
+
+        REQUIRE(util::allocations(3) == 2);
+        REQUIRE(util::counts().copies == 2 * s);
+        REQUIRE(util::counts().moves == 0);
+    }
+
+    SECTION("Reserve")
+    {
+        vec4ca v4(alloc);
+
+        v4.reserve(4);
+
+        REQUIRE(util::allocations(3) == 0);
+
+        v4.reserve(16);
+        v4.reserve(16);
+        v4.reserve(8);
+
+        REQUIRE(util::allocations(3) == 1);
+    }
+
+    SECTION("Push back growth")
+    {
+        std::size_t const n = 1024;
+
+        {
+            vec4ca v4(alloc);
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                v4.push_back(arr[i % s]);
+            }
+
+            // capacities 8, 16, ..., 1024
+            REQUIRE(util::allocations(3) == 8);
+            REQUIRE(util::counts().copies == n);
+            // relocations 4 + 8 + ... + 512
+            REQUIRE(util::counts().moves == n - 4);
+        }
+
+        REQUIRE(util::outstanding(3) == 0);
+        REQUIRE(util::alive() == 0);
+    }
+
+    SECTION("Erase front")
+    {
+        vec4ca v4(arr, arr + s, alloc);
+
+        util::reset_allocations(3);
+        util::reset_counts();
+
+        v4.erase(v4.begin());
+
+        REQUIRE(util::allocations(3) == 0);
+        REQUIRE(util::counts().assignments == s - 1);
+        REQUIRE(util::counts().constructions == 0);
+        REQUIRE(util::counts().destructions == 1);
+    }
+
+    SECTION("Insert front")
+    {
+        vec4ca v4(alloc);
+
+        v4.reserve(s);
+        v4.assign(arr, arr + s - 1);
+
+        util::reset_allocations(3);
+        util::reset_counts();
+
+        v4.insert(v4.begin(), arr[7]);
+
+        // the value is copied aside, the last element is moved into the gap and the rest is shifted
+        REQUIRE(util::allocations(3) == 0);
+        REQUIRE(util::counts().constructions == 2);
+        REQUIRE(util::counts().assignments == s - 1);
+        REQUIRE(util::counts().destructions == 1);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+#ifdef OPT_VSO_HAS_PMR
+TEST_CASE("Polymorphic allocator", "[opt][allocator][pmr]")
+{
+    typedef opt::pmr::vector_short_opt<std::pmr::string, 4> vec4pmr;
+
+    char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    std::size_t const a = util::allocations();
+
+    vec4pmr v4(&arena);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        v4.emplace_back(32, static_cast<char>('a' + i));
+    }
+
+    v4.emplace(v4.begin(), "a string that does not fit the small string buffer");
+    v4.erase(v4.begin() + 1);
+
+    vec4pmr const mv4(std::move(v4));
+
+    bool in_arena = mv4.get_allocator().resource() == &arena;
+
+    for (std::size_t i = 0; i < mv4.size(); ++i)
+    {
+        in_arena = in_arena && mv4[i].get_allocator().resource() == &arena;
+    }
+
+    std::size_t const b = util::allocations();
+
+    REQUIRE(b == a);
+    REQUIRE(in_arena);
+    REQUIRE(mv4.size() == 8);
+}
+////////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Polymorphic allocator staging", "[opt][allocator][pmr]")
+{
+    // elements staged aside while the others move must come from the arena as well
+    typedef opt::pmr::vector_short_opt<std::pmr::string, 4> vec4pmr;
+
+    char buffer[8192];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    std::pmr::string const s("a string that does not fit the small string buffer", &arena);
+
+    vec4pmr v4(&arena);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        v4.emplace_back(s);
+    }
+
+    SECTION("Spilling emplace back")
+    {
+        std::size_t const a = util::allocations();
+
+        v4.emplace_back(s);
+
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a);
+    }
+
+    SECTION("Emplace in the middle")
+    {
+        std::size_t const a = util::allocations();
+
+        v4.emplace(v4.begin() + 1, "another string that does not fit the small string buffer");
+        v4.emplace(v4.begin() + 1, "another string that does not fit the small string buffer");
+
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a);
+    }
+
+    SECTION("Insert in the middle")
+    {
+        std::size_t const a = util::allocations();
+
+        v4.insert(v4.begin() + 2, s);
+        v4.insert(v4.begin() + 2, s);
+
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a);
+    }
+
+    SECTION("Fill insert in the middle")
+    {
+        std::size_t const a = util::allocations();
+
+        v4.insert(v4.begin() + 2, 3, s);
+        v4.insert(v4.begin() + 2, 1, s);
+
+        std::size_t const b = util::allocations();
+
+        REQUIRE(b == a);
+    }
+
+    bool in_arena = true;
+
+    for (std::size_t i = 0; i < v4.size(); ++i)
+    {
+        in_arena = in_arena && v4[i].get_allocator().resource() == &arena;
+    }
+
+    REQUIRE(in_arena);
+}
+////////////////////////////////////////////////////////////////////////////////
+#endif
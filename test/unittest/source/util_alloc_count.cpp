@@ -0,0 +1,186 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#include "util_alloc_count.h"
+
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace
+{
+    std::size_t g_allocations = 0;
+    std::size_t g_deallocations = 0;
+
+    // every block starts with a header holding the requested size, so that the sized
+    // operator delete can check it is handed the same size back
+    std::size_t const header_size = alignof(std::max_align_t);
+
+    void check_size(std::size_t allocated, std::size_t released)
+    {
+        // this also runs in the benchmarks and under any test code, so it cannot use REQUIRE
+        if (allocated != released)
+        {
+            std::fprintf(stderr, "sized operator delete got %zu bytes for a block of %zu\n", released, allocated);
+            std::abort();
+        }
+    }
+
+    void * allocate(std::size_t size)
+    {
+        ++g_allocations;
+
+        void * raw = std::malloc(header_size + size);
+
+        if (raw == NULL)
+        {
+            throw std::bad_alloc();
+        }
+
+        *static_cast<std::size_t *>(raw) = size;
+
+        return static_cast<char *>(raw) + header_size;
+    }
+
+    void deallocate(void * ptr)
+    {
+        if (ptr != NULL)
+        {
+            ++g_deallocations;
+
+            std::free(static_cast<char *>(ptr) - header_size);
+        }
+    }
+
+    void deallocate(void * ptr, std::size_t size)
+    {
+        if (ptr != NULL)
+        {
+            check_size(*reinterpret_cast<std::size_t const *>(static_cast<char *>(ptr) - header_size), size);
+        }
+
+        deallocate(ptr);
+    }
+
+    // over-allocates and keeps the pointer from malloc and the requested size just before the aligned block
+    void * allocate_aligned(std::size_t size, std::size_t alignment)
+    {
+        ++g_allocations;
+
+        void * raw = std::malloc(size + alignment + 2 * sizeof(void *));
+
+        if (raw == NULL)
+        {
+            throw std::bad_alloc();
+        }
+
+        std::uintptr_t const start = reinterpret_cast<std::uintptr_t>(raw) + 2 * sizeof(void *);
+        std::uintptr_t const aligned = (start + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+
+        reinterpret_cast<void **>(aligned)[-1] = raw;
+        reinterpret_cast<std::size_t *>(aligned)[-2] = size;
+
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    void deallocate_aligned(void * ptr)
+    {
+        if (ptr != NULL)
+        {
+            ++g_deallocations;
+
+            std::free(static_cast<void **>(ptr)[-1]);
+        }
+    }
+
+    void deallocate_aligned(void * ptr, std::size_t size)
+    {
+        if (ptr != NULL)
+        {
+            check_size(static_cast<std::size_t const *>(ptr)[-2], size);
+        }
+
+        deallocate_aligned(ptr);
+    }
+}
+
+namespace util
+{
+    std::size_t allocations()
+    {
+        return g_allocations;
+    }
+
+    std::size_t deallocations()
+    {
+        return g_deallocations;
+    }
+}
+
+void * operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void * operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+    deallocate(ptr);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void * ptr, std::size_t size) noexcept
+{
+    deallocate(ptr, size);
+}
+
+void operator delete[](void * ptr, std::size_t size) noexcept
+{
+    deallocate(ptr, size);
+}
+#endif
+
+#if defined(__cpp_aligned_new)
+void * operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate_aligned(size, static_cast<std::size_t>(alignment));
+}
+
+void * operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocate_aligned(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void * ptr, std::align_val_t) noexcept
+{
+    deallocate_aligned(ptr);
+}
+
+void operator delete[](void * ptr, std::align_val_t) noexcept
+{
+    deallocate_aligned(ptr);
+}
+
+void operator delete(void * ptr, std::size_t size, std::align_val_t) noexcept
+{
+    deallocate_aligned(ptr, size);
+}
+
+void operator delete[](void * ptr, std::size_t size, std::align_val_t) noexcept
+{
+    deallocate_aligned(ptr, size);
+}
+#endif
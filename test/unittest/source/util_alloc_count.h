@@ -0,0 +1,13 @@
+#ifndef UTIL_ALLOC_COUNT_H__DDK
+#define UTIL_ALLOC_COUNT_H__DDK
+
+#include <cstddef>
+
+namespace util
+{
+    // number of calls to the global operator new and operator delete so far
+    std::size_t allocations();
+    std::size_t deallocations();
+}
+
+#endif /* UTIL_ALLOC_COUNT_H__DDK */
@@ -0,0 +1,107 @@
+#ifndef UTIL_COUNTED_H__DDK
+#define UTIL_COUNTED_H__DDK
+
+#include <stdexcept>
+#include <cstddef>
+
+namespace util
+{
+    struct counters
+    {
+        std::size_t copies;
+        std::size_t moves;
+        std::size_t constructions; // any constructor, including copy and move
+        std::size_t destructions;
+        std::size_t assignments; // copy and move assignments
+        std::size_t copy_limit; // copy constructions allowed before one throws
+    };
+
+    inline counters & counts()
+    {
+        static counters c = {0, 0, 0, 0, 0, static_cast<std::size_t>(-1)};
+
+        return c;
+    }
+
+    inline void reset_counts(std::size_t copy_limit = static_cast<std::size_t>(-1))
+    {
+        counts().copies = 0;
+        counts().moves = 0;
+        counts().constructions = 0;
+        counts().destructions = 0;
+        counts().assignments = 0;
+        counts().copy_limit = copy_limit;
+    }
+
+    // number of objects constructed since the last reset and not yet destroyed
+    inline long alive()
+    {
+        return static_cast<long>(counts().constructions) - static_cast<long>(counts().destructions);
+    }
+
+    // element type recording how it gets constructed, copied, moved, assigned and destroyed
+    template<bool NothrowMove>
+    class counted
+    {
+        public:
+            counted(int value = 0)
+                : d_value(value)
+            {
+                ++counts().constructions;
+            }
+
+            counted(counted const & other)
+                : d_value(other.d_value)
+            {
+                if (counts().copies == counts().copy_limit)
+                {
+                    throw std::runtime_error("copy limit reached");
+                }
+
+                ++counts().copies;
+                ++counts().constructions;
+            }
+
+            counted(counted && other) noexcept(NothrowMove)
+                : d_value(other.d_value)
+            {
+                ++counts().moves;
+                ++counts().constructions;
+            }
+
+            ~counted()
+            {
+                ++counts().destructions;
+            }
+
+            counted & operator=(counted const & other)
+            {
+                ++counts().copies;
+                ++counts().assignments;
+
+                d_value = other.d_value;
+
+                return *this;
+            }
+
+            counted & operator=(counted && other) noexcept(NothrowMove)
+            {
+                ++counts().moves;
+                ++counts().assignments;
+
+                d_value = other.d_value;
+
+                return *this;
+            }
+
+            int value() const
+            {
+                return d_value;
+            }
+
+        private:
+            int d_value;
+    };
+}
+
+#endif /* UTIL_COUNTED_H__DDK */
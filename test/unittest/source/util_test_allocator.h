@@ -0,0 +1,128 @@
+#ifndef UTIL_TEST_ALLOCATOR_H__DDK
+#define UTIL_TEST_ALLOCATOR_H__DDK
+
+#include "catch/catch.hpp"
+
+#include <map>
+#include <new>
+#include <type_traits>
+#include <cstddef>
+
+namespace util
+{
+    // number of blocks handed out and not yet returned, per allocator id
+    inline std::map<int, long> & outstanding_blocks()
+    {
+        static std::map<int, long> blocks;
+
+        return blocks;
+    }
+
+    inline long outstanding(int id)
+    {
+        return outstanding_blocks()[id];
+    }
+
+    // number of blocks handed out since the last reset, per allocator id
+    inline std::map<int, long> & allocated_blocks()
+    {
+        static std::map<int, long> blocks;
+
+        return blocks;
+    }
+
+    inline long allocations(int id)
+    {
+        return allocated_blocks()[id];
+    }
+
+    inline void reset_allocations(int id)
+    {
+        allocated_blocks()[id] = 0;
+    }
+
+    // element count each live block was allocated with, so that deallocate can check it gets it back
+    inline std::map<void const *, std::size_t> & block_sizes()
+    {
+        static std::map<void const *, std::size_t> sizes;
+
+        return sizes;
+    }
+
+    // stateful allocator; allocators with different ids cannot release each other's memory
+    template<typename T, bool Propagate = false>
+    class test_allocator
+    {
+        public:
+            typedef T value_type;
+
+            typedef std::integral_constant<bool, Propagate> propagate_on_container_copy_assignment;
+            typedef std::integral_constant<bool, Propagate> propagate_on_container_move_assignment;
+            typedef std::integral_constant<bool, Propagate> propagate_on_container_swap;
+            typedef std::false_type is_always_equal;
+
+            template<typename U>
+            struct rebind
+            {
+                typedef test_allocator<U, Propagate> other;
+            };
+
+        public:
+            explicit test_allocator(int id = 0)
+                : d_id(id)
+            {
+            }
+
+            template<typename U>
+            test_allocator(test_allocator<U, Propagate> const & other)
+                : d_id(other.id())
+            {
+            }
+
+            T * allocate(std::size_t n)
+            {
+                T * const ptr = static_cast<T *>(::operator new(n * sizeof(T)));
+
+                ++outstanding_blocks()[d_id];
+                ++allocated_blocks()[d_id];
+                block_sizes()[ptr] = n;
+
+                return ptr;
+            }
+
+            void deallocate(T * ptr, std::size_t n)
+            {
+                std::map<void const *, std::size_t>::iterator const block = block_sizes().find(ptr);
+                bool const known = block != block_sizes().end();
+                std::size_t const allocated = known ? block->second : 0;
+
+                REQUIRE(known);
+                REQUIRE(n == allocated);
+
+                block_sizes().erase(block);
+                --outstanding_blocks()[d_id];
+
+                ::operator delete(ptr);
+            }
+
+            int id() const
+            {
+                return d_id;
+            }
+
+            bool operator==(test_allocator const & rhs) const
+            {
+                return d_id == rhs.d_id;
+            }
+
+            bool operator!=(test_allocator const & rhs) const
+            {
+                return !(*this == rhs);
+            }
+
+        private:
+            int d_id;
+    };
+}
+
+#endif /* UTIL_TEST_ALLOCATOR_H__DDK */
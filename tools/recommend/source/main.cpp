@@ -0,0 +1,87 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+// Reads a CSV dump written by an OPT_VSO_STATS build and recommends an inline capacity N per place
+// of construction, the one for which the bytes taken by the objects plus a cost charged per spill
+// are the lowest. Usage: recommend [--spill-cost BYTES] [--max-n N] stats.csv
+
+#include "recommend.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+
+
+int main(int argc, char * argv[])
+{
+    double spill_cost = 64.0;
+    std::uint64_t max_n = 64;
+    char const * path = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg(argv[i]);
+
+        if (arg == "--spill-cost" && i + 1 < argc)
+        {
+            spill_cost = std::atof(argv[++i]);
+        }
+        else if (arg == "--max-n" && i + 1 < argc)
+        {
+            // sizes from 64 up share buckets, so larger N cannot be told apart
+            max_n = std::min<std::uint64_t>(recommend::number(argv[++i]), 64);
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+
+    if (path == NULL || max_n == 0)
+    {
+        std::cerr << "usage: recommend [--spill-cost BYTES] [--max-n N] stats.csv\n";
+
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream file(path);
+
+    if (!file)
+    {
+        std::cerr << "cannot open " << path << '\n';
+
+        return EXIT_FAILURE;
+    }
+
+    std::vector<recommend::site> const sites = recommend::read(file);
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (std::size_t i = 0; i < sites.size(); ++i)
+    {
+        recommend::site const & s = sites[i];
+
+        if (s.objects == 0)
+        {
+            continue;
+        }
+
+        std::uint64_t const best = recommend::best_capacity(s, spill_cost, max_n);
+
+        recommend::cost const now = recommend::evaluate(s, s.inline_capacity);
+        recommend::cost const then = recommend::evaluate(s, best);
+
+        std::cout << s.file << ':' << s.line << ": N " << s.inline_capacity << " -> " << best
+                  << " (" << s.objects << " objects, spills " << 100.0 * now.spills << "% -> " << 100.0 * then.spills
+                  << "%, bytes per object " << now.bytes << " -> " << then.bytes << ")\n"
+                  << "    " << s.vector << '\n';
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,227 @@
+/*
+    Copyright 2018 Krzysztof Karbowiak
+*/
+
+#ifndef RECOMMEND_H__DDK
+#define RECOMMEND_H__DDK
+
+#include <istream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace recommend
+{
+    struct bucket
+    {
+        std::uint64_t min;
+        std::uint64_t max;
+        std::uint64_t count;
+    };
+
+    struct site
+    {
+        std::string vector;
+        std::string file;
+        std::string line;
+        std::uint64_t inline_capacity;
+        std::uint64_t element_size;
+        std::uint64_t alignment;
+        std::uint64_t objects;
+        std::vector<bucket> peaks;
+    };
+
+    struct cost
+    {
+        double bytes;
+        double spills;
+    };
+
+    // splits a CSV line into fields; fields may be quoted, with quotes doubled inside
+    std::vector<std::string> split(std::string const & line);
+
+    std::uint64_t number(std::string const & field);
+
+    // reads a CSV dump written by opt::write_stats_csv, one site per vector type and place
+    std::vector<site> read(std::istream & is);
+
+    // bytes taken by a vector_short_opt<T, n> with the default size type
+    double footprint(std::uint64_t n, std::uint64_t element_size, std::uint64_t alignment);
+
+    // bytes and spills per object for a given N, assuming the default growth by 2x
+    cost evaluate(site const & s, std::uint64_t n);
+
+    double weigh(cost const & c, double spill_cost);
+
+    // the N from 1 to max_n with the lowest weighed cost, the smallest one on ties
+    std::uint64_t best_capacity(site const & s, double spill_cost, std::uint64_t max_n);
+}
+
+
+namespace recommend
+{
+////////////////////////////////////////////////////////////////////////////////
+inline std::vector<std::string> split(std::string const & line)
+{
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+
+    for (std::size_t i = 0; i < line.size(); ++i)
+    {
+        char const c = line[i];
+
+        if (quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+        {
+            fields.back() += '"';
+            ++i;
+        }
+        else if (c == '"')
+        {
+            quoted = !quoted;
+        }
+        else if (c == ',' && !quoted)
+        {
+            fields.push_back(std::string());
+        }
+        else
+        {
+            fields.back() += c;
+        }
+    }
+
+    return fields;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::uint64_t number(std::string const & field)
+{
+    return std::strtoull(field.c_str(), NULL, 10);
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::vector<site> read(std::istream & is)
+{
+    // vector,file,line,inline_capacity,element_size,alignment,objects,spills,shrinks,wasted_bytes,peak_min,peak_max,count
+    std::vector<site> sites;
+    std::map<std::string, std::size_t> index;
+    std::string line;
+
+    (void) std::getline(is, line);
+
+    while (std::getline(is, line))
+    {
+        std::vector<std::string> const fields = split(line);
+
+        if (fields.size() != 13)
+        {
+            continue;
+        }
+
+        std::string const key = fields[0] + '\n' + fields[1] + '\n' + fields[2];
+        std::map<std::string, std::size_t>::const_iterator const i = index.find(key);
+
+        if (i == index.end())
+        {
+            site s;
+            s.vector = fields[0];
+            s.file = fields[1];
+            s.line = fields[2];
+            s.inline_capacity = number(fields[3]);
+            s.element_size = number(fields[4]);
+            s.alignment = number(fields[5]);
+            s.objects = number(fields[6]);
+
+            index[key] = sites.size();
+            sites.push_back(s);
+        }
+
+        if (!fields[10].empty())
+        {
+            bucket const b = {number(fields[10]), number(fields[11]), number(fields[12])};
+
+            sites[index[key]].peaks.push_back(b);
+        }
+    }
+
+    return sites;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline double footprint(std::uint64_t n, std::uint64_t element_size, std::uint64_t alignment)
+{
+    // data pointer and size, then the inline buffer aligned to Align, sharing its storage with the capacity
+    std::uint64_t const buffer_align = std::max<std::uint64_t>(alignment, alignof(std::size_t));
+    std::uint64_t const object_align = std::max<std::uint64_t>(buffer_align, alignof(void *));
+    std::uint64_t const header = sizeof(void *) + sizeof(std::size_t);
+    std::uint64_t const offset = (header + buffer_align - 1) / buffer_align * buffer_align;
+    std::uint64_t const storage = std::max<std::uint64_t>(n * element_size, sizeof(std::size_t));
+    std::uint64_t const bytes = offset + (storage + buffer_align - 1) / buffer_align * buffer_align;
+
+    return static_cast<double>((bytes + object_align - 1) / object_align * object_align);
+}
+////////////////////////////////////////////////////////////////////////////////
+inline cost evaluate(site const & s, std::uint64_t n)
+{
+    // a power of two bucket is taken at its top end, so that the estimate errs on the side of spilling
+    cost c = {0.0, 0.0};
+
+    for (std::size_t i = 0; i < s.peaks.size(); ++i)
+    {
+        bucket const & b = s.peaks[i];
+        double const count = static_cast<double>(b.count);
+
+        c.bytes += count * footprint(n, s.element_size, s.alignment);
+
+        if (b.max > n)
+        {
+            // a zero N, e.g. from a damaged dump, must not keep the doubling at zero
+            std::uint64_t capacity = std::max<std::uint64_t>(n, 1);
+
+            while (capacity < b.max)
+            {
+                capacity *= 2;
+            }
+
+            c.bytes += count * static_cast<double>(capacity * s.element_size);
+            c.spills += count;
+        }
+    }
+
+    if (s.objects != 0)
+    {
+        c.bytes /= static_cast<double>(s.objects);
+        c.spills /= static_cast<double>(s.objects);
+    }
+
+    return c;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline double weigh(cost const & c, double spill_cost)
+{
+    return c.bytes + c.spills * spill_cost;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::uint64_t best_capacity(site const & s, double spill_cost, std::uint64_t max_n)
+{
+    std::uint64_t best = 1;
+    double best_weight = weigh(evaluate(s, best), spill_cost);
+
+    for (std::uint64_t n = 2; n <= max_n; ++n)
+    {
+        double const weight = weigh(evaluate(s, n), spill_cost);
+
+        if (weight < best_weight)
+        {
+            best = n;
+            best_weight = weight;
+        }
+    }
+
+    return best;
+}
+////////////////////////////////////////////////////////////////////////////////
+}
+
+#endif /* RECOMMEND_H__DDK */
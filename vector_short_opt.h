@@ -6,10 +6,44 @@
 #define SHORT_VECTOR_OPT_H__DDK
 
 #include <iterator>
-#include <vector>
+#include <memory>
+#include <functional>
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <new>
+#include <cstring>
+#include <utility>
+#include <type_traits>
 #include <cstddef>
 
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#   if defined(__has_include)
+#       if __has_include(<memory_resource>)
+#           include <memory_resource>
+#           define OPT_VSO_HAS_PMR
+#       endif
+#   endif
+#endif
+
+#ifdef OPT_VSO_STATS
+#   include <atomic>
+#   include <mutex>
+#   include <vector>
+#   include <map>
+#   include <string>
+#   include <ostream>
+#   include <fstream>
+#   include <typeinfo>
+#   include <cstdlib>
+#   include <cstdint>
+#   include <cstring>
+#   if defined(__GNUG__)
+#       include <cxxabi.h>
+#   endif
+#endif
+
+
 
 namespace opt
 {
@@ -120,17 +154,354 @@ namespace opt
             private:
                 T const * d_pointer;
         };
+
+        // the largest N for which vector_short_opt<T, N> (data pointer, size, and the inline
+        // buffer sharing its storage with the capacity) takes at most Bytes
+        template<typename T, std::size_t Bytes>
+        struct inline_capacity_for
+        {
+            static std::size_t const alignment = alignof(T) > alignof(std::size_t) ? alignof(T) : alignof(std::size_t);
+            static std::size_t const header = (sizeof(T *) + sizeof(std::size_t) + alignment - 1) / alignment * alignment;
+            static std::size_t const budget = Bytes / alignment * alignment;
+            static std::size_t const value = budget > header ? (budget - header) / sizeof(T) : 0;
+
+            static_assert(value > 0, "the byte budget does not leave room for a single inline element");
+        };
+
+        template<typename Alloc>
+        class allocator_holder : private Alloc
+        {
+            public:
+                explicit allocator_holder(Alloc const & alloc);
+
+                Alloc & get_alloc();
+                Alloc const & get_alloc() const;
+        };
+
+        template<typename Alloc>
+        void assign_allocator(Alloc & to, Alloc const & from, std::true_type);
+        template<typename Alloc>
+        void assign_allocator(Alloc & to, Alloc const & from, std::false_type);
+
+        template<typename Alloc>
+        void swap_allocators(Alloc & lhs, Alloc & rhs, std::true_type);
+        template<typename Alloc>
+        void swap_allocators(Alloc & lhs, Alloc & rhs, std::false_type);
+
+        template<typename Alloc, typename T>
+        void destroy_elements(Alloc & alloc, T * first, T * last);
+
+        template<typename Alloc, typename InputIterator, typename T>
+        T * uninitialized_copy_a(Alloc & alloc, InputIterator first, InputIterator last, T * dest);
+
+        template<typename Alloc, typename T>
+        T * uninitialized_fill_n_a(Alloc & alloc, T * dest, std::size_t n, T const & val);
+
+        template<typename Alloc, typename T>
+        T * uninitialized_move_if_noexcept(Alloc & alloc, T * first, T * last, T * dest);
+        template<typename Alloc, typename T>
+        T * uninitialized_move_if_noexcept(Alloc & alloc, T * first, T * last, T * dest, std::true_type);
+        template<typename Alloc, typename T>
+        T * uninitialized_move_if_noexcept(Alloc & alloc, T * first, T * last, T * dest, std::false_type);
+
+        template<typename Alloc, typename T>
+        T * copy_elements(Alloc & alloc, T const * first, T const * last, T * dest);
+        template<typename Alloc, typename T>
+        T * copy_elements(Alloc & alloc, T const * first, T const * last, T * dest, std::true_type);
+        template<typename Alloc, typename T>
+        T * copy_elements(Alloc & alloc, T const * first, T const * last, T * dest, std::false_type);
+
+        template<typename Alloc, typename T>
+        T * relocate_elements(Alloc & alloc, T * first, T * last, T * dest);
+        template<typename Alloc, typename T>
+        T * relocate_elements(Alloc & alloc, T * first, T * last, T * dest, std::true_type);
+        template<typename Alloc, typename T>
+        T * relocate_elements(Alloc & alloc, T * first, T * last, T * dest, std::false_type);
+
+        // The algorithms below shift the elements data[0, size) within storage that has room for them,
+        // for vector_short_opt and static_vector alike. size is kept in step with the elements that
+        // are alive, so that it is right whenever an element operation throws.
+        template<typename Alloc, typename T, typename SizeType, typename ForwardIterator>
+        void insert_range_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, ForwardIterator first, ForwardIterator last, std::size_t count);
+        template<typename Alloc, typename T, typename SizeType, typename ForwardIterator>
+        void insert_range_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, ForwardIterator first, ForwardIterator last, std::size_t count, std::true_type);
+        template<typename Alloc, typename T, typename SizeType, typename ForwardIterator>
+        void insert_range_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, ForwardIterator first, ForwardIterator last, std::size_t count, std::false_type);
+
+        template<typename Alloc, typename T, typename SizeType>
+        void insert_fill_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count, T const & val);
+        template<typename Alloc, typename T, typename SizeType>
+        void insert_fill_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count, T const & val, std::true_type);
+        template<typename Alloc, typename T, typename SizeType>
+        void insert_fill_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count, T const & val, std::false_type);
+
+        template<typename Alloc, typename T, typename SizeType>
+        void insert_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, T && val);
+        template<typename Alloc, typename T, typename SizeType>
+        void insert_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, T && val, std::true_type);
+        template<typename Alloc, typename T, typename SizeType>
+        void insert_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, T && val, std::false_type);
+
+        template<typename Alloc, typename T, typename SizeType>
+        void erase_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count);
+        template<typename Alloc, typename T, typename SizeType>
+        void erase_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count, std::true_type);
+        template<typename Alloc, typename T, typename SizeType>
+        void erase_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count, std::false_type);
+
+        template<typename Alloc, typename T, typename SizeType, typename ForwardIterator>
+        void assign_in_place(Alloc & alloc, T * data, SizeType & size, ForwardIterator first, ForwardIterator last, std::size_t n);
+        template<typename Alloc, typename T, typename SizeType>
+        void assign_fill_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t n, T const & val);
+
+        template<typename Alloc, typename T>
+        void relocate_with_gap(Alloc & alloc, T * data, std::size_t size, T * dest, std::size_t index, std::size_t count);
+        template<typename Alloc, typename T>
+        void relocate_with_gap(Alloc & alloc, T * data, std::size_t size, T * dest, std::size_t index, std::size_t count, std::true_type);
+        template<typename Alloc, typename T>
+        void relocate_with_gap(Alloc & alloc, T * data, std::size_t size, T * dest, std::size_t index, std::size_t count, std::false_type);
+
+        template<typename Alloc, typename T, typename SizeType>
+        void swap_elements(Alloc & alloc, T * lhs, SizeType & lhs_size, T * rhs, SizeType & rhs_size);
+        template<typename Alloc, typename T, typename SizeType>
+        void swap_elements(Alloc & alloc, T * lhs, SizeType & lhs_size, T * rhs, SizeType & rhs_size, std::true_type);
+        template<typename Alloc, typename T, typename SizeType>
+        void swap_elements(Alloc & alloc, T * lhs, SizeType & lhs_size, T * rhs, SizeType & rhs_size, std::false_type);
+
+        // an element constructed through the allocator outside the storage, for values
+        // that may refer to elements about to be moved
+        template<typename T, typename Alloc>
+        class temporary_value
+        {
+            public:
+                template<typename... Args>
+                explicit temporary_value(Alloc & alloc, Args &&... args);
+                ~temporary_value();
+
+                temporary_value(temporary_value const &) = delete;
+                temporary_value & operator=(temporary_value const &) = delete;
+
+                T & get();
+
+            private:
+                Alloc & d_alloc;
+                alignas(T) unsigned char d_storage[sizeof(T)];
+        };
+    }
+}
+
+namespace opt
+{
+    // Tells whether moving an object to another address and ending the lifetime of the source
+    // amounts to copying its bytes. Trivially copyable types are, users may specialise it for others.
+    template<typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T>
+    {
+    };
+
+    // Shrink policies decide whether a spilled vector that got small enough for the inline buffer
+    // goes back there on its own, i.e. after pop_back, erase, resize or clear. shrink_to_fit always does.
+    struct shrink_never
+    {
+        static bool should_shrink(std::size_t size);
+    };
+
+    // leaves the heap once the size drops to LowWater; keeping it below N gives some hysteresis,
+    // so that a vector hovering around N does not bounce between the buffers
+    template<std::size_t LowWater>
+    struct shrink_below
+    {
+        static bool should_shrink(std::size_t size);
+    };
+
+    // Growth policies pick the capacity of a new heap block when push_back, emplace or insert run
+    // out of room. capacity is N while spilling from the inline buffer; the result is raised to n if smaller.
+    template<std::size_t Num, std::size_t Den>
+    struct grow_by
+    {
+        static std::size_t next_capacity(std::size_t capacity, std::size_t n, bool spilling, std::size_t element_size);
+    };
+
+    typedef grow_by<3, 2> grow_1_5x;
+    typedef grow_by<2, 1> grow_2x;
+
+    // jumps to 2N when leaving the inline buffer, then grows by half
+    struct grow_first_spill_2n
+    {
+        static std::size_t next_capacity(std::size_t capacity, std::size_t n, bool spilling, std::size_t element_size);
+    };
+
+    // at least doubles, rounded up so that the capacity in bytes is a power of two; the allocator
+    // may still add its own overhead, e.g. glibc malloc puts a power of two in a larger chunk
+    struct grow_size_class
+    {
+        static std::size_t next_capacity(std::size_t capacity, std::size_t n, bool spilling, std::size_t element_size);
+    };
+}
+
+#ifdef OPT_VSO_STATS
+namespace opt
+{
+    namespace detail
+    {
+        // peak sizes below stats_exact get a bucket each, larger ones a bucket per power of two
+        std::size_t const stats_exact = 64;
+        std::size_t const stats_buckets = stats_exact + 64 - 6;
+
+        std::size_t stats_bucket(std::uint64_t size);
+        std::uint64_t stats_bucket_min(std::size_t bucket);
+        std::uint64_t stats_bucket_max(std::size_t bucket);
+
+        struct stats_totals
+        {
+            stats_totals();
+
+            std::uint64_t objects;
+            std::uint64_t spills;
+            std::uint64_t shrinks;
+            std::uint64_t wasted_bytes;
+            std::uint64_t peaks[stats_buckets];
+        };
+
+        // lock-free, and written by a single thread but in the rare fallback to the shared counters of a site
+        struct stats_counters
+        {
+            stats_counters();
+
+            void add_to(stats_totals & totals) const;
+
+            std::atomic<std::uint64_t> objects;
+            std::atomic<std::uint64_t> spills;
+            std::atomic<std::uint64_t> shrinks;
+            std::atomic<std::uint64_t> wasted_bytes;
+            std::atomic<std::uint64_t> peaks[stats_buckets];
+        };
+
+        void stats_add(std::atomic<std::uint64_t> & counter, std::uint64_t n);
+
+        // where a vector_short_opt gets constructed, as reported by the same builtins std::source_location uses
+        struct stats_location
+        {
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1926)
+            static stats_location current(char const * file = __builtin_FILE(), unsigned line = __builtin_LINE()) noexcept;
+#else
+            static stats_location current(char const * file = "", unsigned line = 0) noexcept;
+#endif
+
+            char const * file;
+            unsigned line;
+        };
+
+        // everything recorded for the vector_short_opt objects of one type constructed at one place;
+        // threads attach their counters on first use and fold them into the retired totals when they end
+        class stats_site
+        {
+            public:
+                stats_site(std::type_info const & type, std::size_t inline_capacity, std::size_t element_size, std::size_t alignment, stats_location location);
+
+                void attach(stats_counters const * counters);
+                void detach(stats_counters const * counters);
+                stats_counters & shared();
+
+                bool is_at(std::type_info const & type, stats_location location) const;
+
+                std::string const & name() const;
+                std::string const & file() const;
+                unsigned line() const;
+                std::size_t inline_capacity() const;
+                std::size_t element_size() const;
+                std::size_t alignment() const;
+                stats_totals totals() const;
+
+            private:
+                std::type_info const & d_type;
+                std::string d_name;
+                std::string d_file;
+                unsigned d_line;
+                std::size_t d_inline_capacity;
+                std::size_t d_element_size;
+                std::size_t d_alignment;
+                mutable std::mutex d_mutex;
+                stats_totals d_retired;
+                std::vector<stats_counters const *> d_live;
+                stats_counters d_shared;
+        };
+
+        struct stats_key
+        {
+            bool operator<(stats_key const & rhs) const;
+
+            std::type_info const * type;
+            char const * file;
+            unsigned line;
+        };
+
+        // what a thread knows: the sites it has seen and its own counters for each of them
+        class stats_thread
+        {
+            public:
+                explicit stats_thread(bool & finished);
+                ~stats_thread();
+
+                stats_site * find(stats_key const & key) const;
+                void add(stats_key const & key, stats_site * site);
+                stats_counters & counters(stats_site & site);
+
+            private:
+                stats_thread(stats_thread const &);
+                stats_thread & operator=(stats_thread const &);
+
+            private:
+                bool & d_finished;
+                std::map<stats_key, stats_site *> d_sites;
+                std::map<stats_site *, stats_counters *> d_counters;
+        };
+
+        // sites are never destroyed, so that the dump at exit and late threads can still reach them
+        std::mutex & stats_mutex();
+        std::vector<stats_site *> & stats_sites();
+        stats_site & stats_register(std::type_info const & type, std::size_t inline_capacity, std::size_t element_size, std::size_t alignment, stats_location location);
+        void stats_at_exit();
+
+        // null once the thread has started to end
+        stats_thread * stats_current_thread();
+
+        stats_site & stats_find_site(std::type_info const & type, std::size_t inline_capacity, std::size_t element_size, std::size_t alignment, stats_location location);
+        stats_counters & stats_local(stats_site & site);
+
+        std::string stats_type_name(std::type_info const & type);
+        void stats_write_quoted(std::ostream & os, std::string const & str, char escape);
+        void stats_write_prefix(std::ostream & os, stats_site const & site, stats_totals const & totals);
     }
+
+    // Write what OPT_VSO_STATS builds recorded so far: per vector_short_opt type and place of construction
+    // the number of destroyed objects, spills, shrinks back to the inline buffer, bytes of capacity left
+    // unused at destruction, and a histogram of the largest size each object reached. If OPT_VSO_STATS_FILE
+    // is set, the same gets written there at exit, as JSON if the name ends with .json and as CSV otherwise.
+    void write_stats_csv(std::ostream & os);
+    void write_stats_json(std::ostream & os);
 }
 
+// the constructors take the place they are called from as an extra defaulted argument
+#   define OPT_VSO_STATS_PARAM , detail::stats_location location = detail::stats_location::current()
+#   define OPT_VSO_STATS_ARG , detail::stats_location location
+#   define OPT_VSO_STATS_INIT , d_site(&detail::stats_find_site(typeid(vector_short_opt), N, sizeof(T), Align, location))
+#else
+#   define OPT_VSO_STATS_PARAM
+#   define OPT_VSO_STATS_ARG
+#   define OPT_VSO_STATS_INIT
+#endif
+
 namespace opt
 {
-    template<typename T, std::size_t N>
-    class vector_short_opt
+    // Align can raise the alignment of the inline buffer above alignof(T), e.g. to 32 or 64 for SIMD
+    // kernels; spilled storage comes from Alloc, which has to provide the same alignment if it matters
+    template<typename T, std::size_t N, typename Alloc = std::allocator<T>, std::size_t Align = alignof(T), typename ShrinkPolicy = shrink_never, typename GrowthPolicy = grow_2x, typename SizeType = std::size_t>
+    class vector_short_opt : private detail::allocator_holder<Alloc>
     {
         public:
             typedef T value_type;
-            typedef typename std::vector<T>::allocator_type allocator_type;
+            typedef Alloc allocator_type;
             typedef T & reference;
             typedef T * pointer;
             typedef T const & const_reference;
@@ -143,16 +514,20 @@ namespace opt
             typedef std::ptrdiff_t difference_type;
             typedef std::size_t size_type;
 
+            static size_type const static_capacity = N;
+
         public:
-            explicit vector_short_opt(allocator_type const & alloc = allocator_type());
-            explicit vector_short_opt(size_type n, value_type const & val = value_type(), allocator_type const & alloc = allocator_type());
+            explicit vector_short_opt(allocator_type const & alloc = allocator_type() OPT_VSO_STATS_PARAM);
+            explicit vector_short_opt(size_type n, value_type const & val = value_type(), allocator_type const & alloc = allocator_type() OPT_VSO_STATS_PARAM);
             template <class InputIterator>
-            vector_short_opt(InputIterator first, InputIterator last, allocator_type const & alloc = allocator_type());
-            vector_short_opt(vector_short_opt const & other);
+            vector_short_opt(InputIterator first, InputIterator last, allocator_type const & alloc = allocator_type() OPT_VSO_STATS_PARAM);
+            vector_short_opt(vector_short_opt const & other OPT_VSO_STATS_PARAM);
+            vector_short_opt(vector_short_opt && other OPT_VSO_STATS_PARAM) noexcept(std::is_nothrow_move_constructible<T>::value);
 
             ~vector_short_opt();
 
             vector_short_opt & operator=(vector_short_opt const & other);
+            vector_short_opt & operator=(vector_short_opt && other) noexcept(std::is_nothrow_move_constructible<T>::value && (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value));
 
             iterator begin();
             const_iterator begin() const;
@@ -164,9 +539,13 @@ namespace opt
             reverse_iterator rend();
             const_reverse_iterator rend() const;
 
-            void resize(size_type n, value_type val = value_type());
+            void resize(size_type n);
+            void resize(size_type n, value_type const & val);
+            void resize_for_overwrite(size_type n);
+            iterator append_for_overwrite(size_type n);
 
             void reserve(size_type n);
+            void shrink_to_fit();
 
             reference operator[] (size_type n);
             const_reference operator[] (size_type n) const;
@@ -184,18 +563,26 @@ namespace opt
             void assign(size_type n, value_type const & val);
 
             void push_back(value_type const & val);
+            void push_back(value_type && val);
+            template <class... Args>
+            reference emplace_back(Args &&... args);
             void pop_back();
 
             iterator insert(iterator position, value_type const & val);
+            iterator insert(iterator position, value_type && val);
             void insert(iterator position, size_type n, value_type const & val);
             template <class InputIterator>
             void insert(iterator position, InputIterator first, InputIterator last);
+            template <class... Args>
+            iterator emplace(iterator position, Args &&... args);
 
             iterator erase(iterator position);
             iterator erase(iterator first, iterator last);
 
             void clear();
 
+            void swap(vector_short_opt & other) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value);
+
             bool empty() const;
             size_type size() const;
             size_type capacity() const;
@@ -203,6 +590,15 @@ namespace opt
 
             allocator_type get_allocator() const;
 
+        private:
+            typedef std::allocator_traits<Alloc> alloc_traits;
+
+            static_assert(std::is_same<typename alloc_traits::value_type, T>::value, "allocator value_type must be T");
+            static_assert(std::is_same<typename alloc_traits::pointer, T *>::value, "allocators with fancy pointers are not supported");
+            static_assert((Align & (Align - 1)) == 0 && Align % alignof(T) == 0, "Align must be a power of two and a multiple of alignof(T)");
+            static_assert(std::is_integral<SizeType>::value && std::is_unsigned<SizeType>::value, "SizeType must be an unsigned integral type");
+            static_assert(N <= std::numeric_limits<SizeType>::max(), "N must fit in SizeType");
+
         private:
             pointer get_ptr(size_type index);
             const_pointer get_ptr(size_type index) const;
@@ -210,688 +606,1849 @@ namespace opt
             reference get_ref(size_type index);
             const_reference get_ref(size_type index) const;
 
-            void construct(size_type index, value_type const & val);
+            template <class... Args>
+            void construct(size_type index, Args &&... args);
             void destroy(size_type index);
 
-            void move_array_to_vector();
+            size_type grow_capacity(size_type n) const;
+            void check_length(size_type n) const;
+            void move_to_heap(size_type capacity);
+            void move_to_array();
+            void reserve_for_append(size_type n);
+
+            void default_init_back(size_type n, std::true_type);
+            void default_init_back(size_type n, std::false_type);
+
+            void shrink_if_low();
+            void shrink_if_low(std::true_type);
+            void shrink_if_low(std::false_type);
+
+            template <class InputIterator>
+            void insert_range(size_type index, InputIterator first, InputIterator last, std::true_type);
+            template <class InputIterator>
+            void insert_range(size_type index, InputIterator first, InputIterator last, std::false_type);
+            template <class InputIterator>
+            void insert_range(size_type index, InputIterator first, InputIterator last, std::input_iterator_tag);
+            template <class ForwardIterator>
+            void insert_range(size_type index, ForwardIterator first, ForwardIterator last, std::forward_iterator_tag);
+
+            void erase_shifted(size_type index, size_type count);
+
+            pointer get_array_ptr();
+            bool is_array_used() const;
+
+            void move_from(vector_short_opt & other);
+
+            template <class InputIterator>
+            void assign_range(InputIterator first, InputIterator last, std::true_type);
+            template <class InputIterator>
+            void assign_range(InputIterator first, InputIterator last, std::false_type);
+            template <class InputIterator>
+            void assign_range(InputIterator first, InputIterator last, std::input_iterator_tag);
+            template <class ForwardIterator>
+            void assign_range(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag);
+            template <class ForwardIterator>
+            void assign_sized(ForwardIterator first, ForwardIterator last, size_type n);
+
+            void swap_heap_with_array(vector_short_opt & other);
+            void swap_arrays(vector_short_opt & other);
 
             void destroy_array();
+            void deallocate();
+
+            // no-ops unless OPT_VSO_STATS is defined
+            void record_peak();
+            void record_spill();
+            void record_shrink();
+            void record_destruction();
+            void take_peak(vector_short_opt & other);
 
         private:
-            char d_array[N * sizeof(T)];
-            size_type d_size;
-            bool d_array_used;
-            std::vector<T> d_vector;
+            pointer d_data;
+            SizeType d_size;
+            union
+            {
+                alignas(Align) char d_array[N * sizeof(T)];
+                SizeType d_capacity;
+            };
+#ifdef OPT_VSO_STATS
+            SizeType d_peak = 0;
+            detail::stats_site * d_site;
+#endif
     };
+
+    template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+    void swap(vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType> & lhs, vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType> & rhs) noexcept(noexcept(lhs.swap(rhs)));
 }
 
+namespace opt
+{
+    // picks the inline capacity from a byte budget for the whole object, by default a cache line,
+    // so that e.g. structs of vectors stay packed whatever the element type
+    template<typename T, std::size_t Bytes = 64>
+    using small_vector_for = vector_short_opt<T, detail::inline_capacity_for<T, Bytes>::value>;
+}
+
+#ifdef OPT_VSO_HAS_PMR
+namespace opt
+{
+    namespace pmr
+    {
+        // spills into a std::pmr::memory_resource; elements that are allocator-aware
+        // themselves (e.g. std::pmr::string) get the same resource through uses-allocator construction
+        template<typename T, std::size_t N>
+        using vector_short_opt = opt::vector_short_opt<T, N, std::pmr::polymorphic_allocator<T> >;
+    }
+}
+#endif
+
+// GCC folds identical member functions of vector_short_opt with different N, after which
+// -Warray-bounds sees e.g. the heap capacity of a <T, 64> read from a smaller <T, 1>
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
 
 namespace opt
 {
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline vector_short_opt<T, N>::vector_short_opt(allocator_type const & alloc)
-    : d_size(0)
-    , d_array_used(true)
-    , d_vector(alloc)
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::size_type const vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::static_capacity;
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::vector_short_opt(allocator_type const & alloc OPT_VSO_STATS_ARG)
+    : detail::allocator_holder<Alloc>(alloc)
+    , d_data(get_array_ptr())
+    , d_size(0)
+    OPT_VSO_STATS_INIT
 {
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline vector_short_opt<T, N>::vector_short_opt(size_type n, value_type const & val, allocator_type const & alloc)
-    : d_size(0)
-    , d_array_used(n < N)
-    , d_vector(alloc)
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::vector_short_opt(size_type n, value_type const & val, allocator_type const & alloc OPT_VSO_STATS_ARG)
+    : detail::allocator_holder<Alloc>(alloc)
+    , d_data(get_array_ptr())
+    , d_size(0)
+    OPT_VSO_STATS_INIT
 {
-    if (d_array_used)
-    {
-        try
-        {
-            while (d_size < n)
-            {
-                construct(d_size, val);
+    reserve(n);
 
-                ++d_size;
-            }
-        }
-        catch (...)
+    try
+    {
+        while (d_size < n)
         {
-            destroy_array();
+            construct(d_size, val);
 
-            throw;
+            ++d_size;
         }
     }
-    else
+    catch (...)
     {
-        d_vector = std::vector<T>(n, val, alloc);
+        destroy_array();
+        deallocate();
+
+        throw;
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
 template <class InputIterator>
-inline vector_short_opt<T, N>::vector_short_opt(InputIterator first, InputIterator last, allocator_type const & alloc)
-    : d_size(0)
-    , d_array_used(true)
-    , d_vector(alloc)
+inline vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::vector_short_opt(InputIterator first, InputIterator last, allocator_type const & alloc OPT_VSO_STATS_ARG)
+    : detail::allocator_holder<Alloc>(alloc)
+    , d_data(get_array_ptr())
+    , d_size(0)
+    OPT_VSO_STATS_INIT
 {
     try
     {
-        for (InputIterator i = first; i != last; ++i)
-        {
-            push_back(*i);
-        }
+        assign(first, last);
     }
     catch (...)
     {
         destroy_array();
+        deallocate();
 
         throw;
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline vector_short_opt<T, N>::vector_short_opt(vector_short_opt const & other)
-    : d_size(0)
-    , d_array_used(other.d_array_used)
-    , d_vector(other.d_vector)
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::vector_short_opt(vector_short_opt const & other OPT_VSO_STATS_ARG)
+    : detail::allocator_holder<Alloc>(alloc_traits::select_on_container_copy_construction(other.get_alloc()))
+    , d_data(get_array_ptr())
+    , d_size(0)
+    OPT_VSO_STATS_INIT
 {
-    if (d_array_used)
+    reserve(other.d_size);
+
+    try
     {
-        try
-        {
-            while (d_size < other.d_size)
-            {
-                construct(d_size, *other.get_ptr(d_size));
+        (void) detail::copy_elements(this->get_alloc(), other.get_ptr(0), other.get_ptr(other.d_size), d_data);
 
-                ++d_size;
-            }
-        }
-        catch (...)
-        {
-            destroy_array();
+        d_size = other.d_size;
+    }
+    catch (...)
+    {
+        deallocate();
 
-            throw;
-        }
+        throw;
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline vector_short_opt<T, N>::~vector_short_opt()
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::vector_short_opt(vector_short_opt && other OPT_VSO_STATS_ARG) noexcept(std::is_nothrow_move_constructible<T>::value)
+    : detail::allocator_holder<Alloc>(std::move(other.get_alloc()))
+    , d_data(get_array_ptr())
+    , d_size(0)
+    OPT_VSO_STATS_INIT
+{
+    move_from(other);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::~vector_short_opt()
 {
-    if (d_array_used)
+    record_destruction();
+    destroy_array();
+    deallocate();
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType> & vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::operator=(vector_short_opt const & other)
+{
+    if (this != &other)
     {
-        destroy_array();
+        if (alloc_traits::propagate_on_container_copy_assignment::value && this->get_alloc() != other.get_alloc())
+        {
+            // the heap block must go back to the allocator it came from
+            clear();
+            deallocate();
+
+            d_data = get_array_ptr();
+        }
+
+        detail::assign_allocator(this->get_alloc(), other.get_alloc(), typename alloc_traits::propagate_on_container_copy_assignment());
+
+        assign_sized(other.get_ptr(0), other.get_ptr(other.d_size), other.d_size);
     }
+
+    return *this;
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline vector_short_opt<T, N> & vector_short_opt<T, N>::operator=(vector_short_opt const & other)
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType> & vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::operator=(vector_short_opt && other) noexcept(std::is_nothrow_move_constructible<T>::value && (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value))
 {
-    assign(other.begin(), other.end()); // TODO: replace with proper assignment operation
+    if (this != &other)
+    {
+        bool const equal = this->get_alloc() == other.get_alloc();
+
+        clear();
+
+        if (alloc_traits::propagate_on_container_move_assignment::value || equal)
+        {
+            if (!other.is_array_used() || !equal)
+            {
+                deallocate();
+
+                d_data = get_array_ptr();
+            }
+
+            detail::assign_allocator(this->get_alloc(), other.get_alloc(), typename alloc_traits::propagate_on_container_move_assignment());
+
+            move_from(other);
+        }
+        else
+        {
+            // the heap block of other cannot be released through our allocator
+            reserve(other.d_size);
+
+            for (; d_size < other.d_size; ++d_size)
+            {
+                construct(d_size, std::move(*other.get_ptr(d_size)));
+            }
+
+            other.clear();
+        }
+    }
 
     return *this;
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::iterator vector_short_opt<T, N>::begin()
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::begin()
 {
-    pointer ptr = d_array_used
-        ? get_ptr(0)
-        : d_vector.empty()
-            ? NULL
-            : &d_vector[0];
-
-    return iterator(ptr);
+    return iterator(get_ptr(0));
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::const_iterator vector_short_opt<T, N>::begin() const
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::const_iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::begin() const
 {
-    const_pointer ptr = d_array_used
-        ? get_ptr(0)
-        : d_vector.empty()
-            ? NULL
-            : &d_vector[0];
-
-    return const_iterator(ptr);
+    return const_iterator(get_ptr(0));
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::iterator vector_short_opt<T, N>::end()
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::end()
 {
-    pointer ptr = d_array_used
-        ? get_ptr(d_size)
-        : d_vector.empty()
-            ? NULL
-            : &d_vector[0] + d_vector.size();
-
-    return iterator(ptr);
+    return iterator(get_ptr(d_size));
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::const_iterator vector_short_opt<T, N>::end() const
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::const_iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::end() const
 {
-    const_pointer ptr = d_array_used
-        ? get_ptr(d_size)
-        : d_vector.empty()
-            ? NULL
-            : &d_vector[0] + d_vector.size();
-
-    return const_iterator(ptr);
+    return const_iterator(get_ptr(d_size));
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::reverse_iterator vector_short_opt<T, N>::rbegin()
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::reverse_iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::rbegin()
 {
     return reverse_iterator(end());
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::const_reverse_iterator vector_short_opt<T, N>::rbegin() const
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::const_reverse_iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::rbegin() const
 {
     return const_reverse_iterator(end());
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::reverse_iterator vector_short_opt<T, N>::rend()
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::reverse_iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::rend()
 {
     return reverse_iterator(begin());
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::const_reverse_iterator vector_short_opt<T, N>::rend() const
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::const_reverse_iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::rend() const
 {
     return const_reverse_iterator(begin());
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::resize(size_type n, value_type val)
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::resize(size_type n)
 {
-    if (d_array_used)
+    if (n < d_size)
     {
-        if (n <= N)
-        {
-            if (n < d_size)
-            {
-                for (size_type i = n; i < d_size; ++i)
-                {
-                    destroy(i);
-                }
-
-                d_size = n;
-            }
-            else if (n == d_size)
-            {
-                // do nothing
-            }
-            else
-            {
-                for (; d_size != n; ++d_size)
-                {
-                    construct(d_size, val);
-                }
-            }
-        }
-        else
-        {
-            d_array_used = false;
-
-            d_vector.reserve(n);
-
-            move_array_to_vector();
-
-            d_vector.resize(n, val);
-        }
+        erase_shifted(n, d_size - n);
+    }
+    else if (n == d_size)
+    {
+        // do nothing
     }
     else
     {
-        d_vector.resize(n, val);
+        reserve_for_append(n - d_size);
+
+        for (; d_size != n; ++d_size)
+        {
+            construct(d_size);
+        }
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::reserve(size_type n)
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::resize(size_type n, value_type const & val)
 {
-    if (d_array_used)
+    if (n < d_size)
     {
-        if (n <= N)
-        {
-            // do nothing
-        }
-        else
-        {
-            d_array_used = false;
-
-            d_vector.reserve(n);
-
-            move_array_to_vector();
-        }
+        erase_shifted(n, d_size - n);
+    }
+    else if (n == d_size)
+    {
+        // do nothing
     }
     else
     {
-        d_vector.reserve(n);
+        // takes care of val referring to one of the elements
+        insert(end(), n - d_size, val);
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::reference vector_short_opt<T, N>::operator[](size_type n)
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::resize_for_overwrite(size_type n)
 {
-    if (d_array_used)
+    if (n < d_size)
     {
-        return *get_ptr(n);
+        erase_shifted(n, d_size - n);
+    }
+    else if (n == d_size)
+    {
+        // do nothing
     }
     else
     {
-        return d_vector[n];
+        (void) append_for_overwrite(n - d_size);
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::const_reference vector_short_opt<T, N>::operator[](size_type n) const
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::append_for_overwrite(size_type n)
+{
+    // new elements are default-initialised, which leaves trivial types with indeterminate values
+    size_type const index = d_size;
+
+    reserve_for_append(n);
+
+    default_init_back(n, typename std::is_trivially_default_constructible<T>::type());
+
+    return iterator(get_ptr(index));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::reserve(size_type n)
 {
-    if (d_array_used)
+    if (n <= capacity())
     {
-        return *get_ptr(n);
+        // do nothing
     }
     else
     {
-        return d_vector[n];
+        check_length(n);
+
+        move_to_heap(n);
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::reference vector_short_opt<T, N>::at(size_type n)
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::shrink_to_fit()
 {
-    if (d_array_used)
+    if (is_array_used())
     {
-        if (n < d_size)
-        {
-            return *get_ptr(n);
-        }
-        else
-        {
-            throw std::out_of_range("");
-        }
+        // do nothing
     }
-    else
+    else if (d_size <= N)
     {
-        return d_vector.at(n);
+        move_to_array();
     }
-}
-////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::const_reference vector_short_opt<T, N>::at(size_type n) const
-{
-    if (d_array_used)
+    else if (d_size < d_capacity)
     {
-        if (n < d_size)
-        {
-            return *get_ptr(n);
-        }
-        else
-        {
-            throw std::out_of_range("");
-        }
+        move_to_heap(d_size);
     }
     else
     {
-        return d_vector.at(n);
+        // do nothing
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::reference vector_short_opt<T, N>::front()
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::operator[](size_type n)
 {
-    return d_array_used
-        ? *get_ptr(0)
-        : d_vector.front();
+    return *get_ptr(n);
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::const_reference vector_short_opt<T, N>::front()  const
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::const_reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::operator[](size_type n) const
 {
-    return d_array_used
-        ? *get_ptr(0)
-        : d_vector.front();
+    return *get_ptr(n);
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::reference vector_short_opt<T, N>::back()
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::at(size_type n)
 {
-    return d_array_used
-        ? *get_ptr(d_size - 1)
-        : d_vector.front();
+    if (n < d_size)
+    {
+        return *get_ptr(n);
+    }
+    else
+    {
+        throw std::out_of_range("");
+    }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::const_reference vector_short_opt<T, N>::back() const
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::const_reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::at(size_type n) const
 {
-    return d_array_used
-        ? *get_ptr(d_size - 1)
-        : d_vector.front();
-}
-////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
+    if (n < d_size)
+    {
+        return *get_ptr(n);
+    }
+    else
+    {
+        throw std::out_of_range("");
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::front()
+{
+    return *get_ptr(0);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::const_reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::front()  const
+{
+    return *get_ptr(0);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::back()
+{
+    return *get_ptr(d_size - 1);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::const_reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::back() const
+{
+    return *get_ptr(d_size - 1);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class InputIterator>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::assign(InputIterator first, InputIterator last)
+{
+    assign_range(first, last, typename std::is_integral<InputIterator>::type());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::assign(size_type n, value_type const & val)
+{
+    clear();
+
+    reserve(n);
+
+    for (; d_size < n; ++d_size)
+    {
+        construct(d_size, val);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::push_back(value_type const & val)
+{
+    (void) emplace_back(val);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::push_back(value_type && val)
+{
+    (void) emplace_back(std::move(val));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class... Args>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::emplace_back(Args &&... args)
+{
+    if (d_size < capacity())
+    {
+        construct(d_size, std::forward<Args>(args)...);
+
+        ++d_size;
+    }
+    else
+    {
+        // the new element is built in its final slot before the old ones are relocated,
+        // so args may still refer to one of them
+        size_type const capacity = grow_capacity(d_size + 1);
+        pointer const ptr = alloc_traits::allocate(this->get_alloc(), capacity);
+
+        try
+        {
+            alloc_traits::construct(this->get_alloc(), ptr + d_size, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            alloc_traits::deallocate(this->get_alloc(), ptr, capacity);
+
+            throw;
+        }
+
+        try
+        {
+            (void) detail::relocate_elements(this->get_alloc(), get_ptr(0), get_ptr(d_size), ptr);
+        }
+        catch (...)
+        {
+            alloc_traits::destroy(this->get_alloc(), ptr + d_size);
+            alloc_traits::deallocate(this->get_alloc(), ptr, capacity);
+
+            throw;
+        }
+
+        record_spill();
+        deallocate();
+
+        d_data = ptr;
+        ++d_size;
+        d_capacity = capacity;
+    }
+
+    return back();
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::pop_back()
+{
+    record_peak();
+    destroy(--d_size);
+
+    shrink_if_low();
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::insert(iterator position, value_type const & val)
+{
+    return emplace(position, val);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::insert(iterator position, value_type && val)
+{
+    return emplace(position, std::move(val));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::insert(iterator position, size_type n, value_type const & val)
+{
+    size_type const index = position - begin();
+
+    if (n == 0)
+    {
+        // do nothing
+    }
+    else if (d_size + n <= capacity())
+    {
+        detail::insert_fill_in_place(this->get_alloc(), get_ptr(0), d_size, index, n, val);
+    }
+    else
+    {
+        size_type const capacity = grow_capacity(d_size + n);
+        pointer const ptr = alloc_traits::allocate(this->get_alloc(), capacity);
+
+        try
+        {
+            (void) detail::uninitialized_fill_n_a(this->get_alloc(), ptr + index, n, val);
+        }
+        catch (...)
+        {
+            alloc_traits::deallocate(this->get_alloc(), ptr, capacity);
+
+            throw;
+        }
+
+        try
+        {
+            detail::relocate_with_gap(this->get_alloc(), get_ptr(0), d_size, ptr, index, n);
+        }
+        catch (...)
+        {
+            detail::destroy_elements(this->get_alloc(), ptr + index, ptr + index + n);
+            alloc_traits::deallocate(this->get_alloc(), ptr, capacity);
+
+            throw;
+        }
+
+        record_spill();
+        deallocate();
+
+        d_data = ptr;
+        d_size += n;
+        d_capacity = capacity;
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class InputIterator>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::insert(iterator position, InputIterator first, InputIterator last)
+{
+    insert_range(position - begin(), first, last, typename std::is_integral<InputIterator>::type());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class... Args>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::emplace(iterator position, Args &&... args)
+{
+    size_type const index = position - begin();
+
+    if (index == d_size)
+    {
+        (void) emplace_back(std::forward<Args>(args)...);
+    }
+    else
+    {
+        // args may refer to an element that is about to be shifted
+        detail::temporary_value<T, Alloc> tmp(this->get_alloc(), std::forward<Args>(args)...);
+
+        if (d_size == capacity())
+        {
+            move_to_heap(grow_capacity(d_size + 1));
+        }
+
+        detail::insert_shifted(this->get_alloc(), get_ptr(0), d_size, index, std::move(tmp.get()));
+    }
+
+    return iterator(get_ptr(index));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::erase(iterator position)
+{
+    // the elements may have moved back to the inline buffer, so position is recomputed
+    size_type const index = position - begin();
+
+    erase_shifted(index, 1);
+
+    return iterator(get_ptr(index));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::iterator vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::erase(iterator first, iterator last)
+{
+    size_type const index = first - begin();
+
+    if (first != last)
+    {
+        erase_shifted(index, last - first);
+    }
+
+    return iterator(get_ptr(index));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::clear()
+{
+    record_peak();
+    destroy_array();
+
+    d_size = 0;
+
+    shrink_if_low();
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::swap(vector_short_opt & other) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value)
+{
+    // as with std::vector, allocators that do not propagate on swap must compare equal
+    record_peak();
+    other.record_peak();
+
+    if (this == &other)
+    {
+        // do nothing
+    }
+    else if (!is_array_used() && !other.is_array_used())
+    {
+        std::swap(d_data, other.d_data);
+        std::swap(d_size, other.d_size);
+        std::swap(d_capacity, other.d_capacity);
+    }
+    else if (!is_array_used())
+    {
+        swap_heap_with_array(other);
+    }
+    else if (!other.is_array_used())
+    {
+        other.swap_heap_with_array(*this);
+    }
+    else
+    {
+        swap_arrays(other);
+    }
+
+    detail::swap_allocators(this->get_alloc(), other.get_alloc(), typename alloc_traits::propagate_on_container_swap());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline bool vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::empty() const
+{
+    return d_size == 0;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::size_type vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::size() const
+{
+    return d_size;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::size_type vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::capacity() const
+{
+    return is_array_used()
+        ? N
+        : d_capacity;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::size_type vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::max_size() const
+{
+    size_type const limit = std::min<size_type>(alloc_traits::max_size(this->get_alloc()), std::numeric_limits<difference_type>::max() / sizeof(T));
+
+    return std::min<size_type>(limit, std::numeric_limits<SizeType>::max());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::allocator_type vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::get_allocator() const
+{
+    return this->get_alloc();
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::pointer vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::get_ptr(size_type index)
+{
+    return (d_data + index);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::const_pointer vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::get_ptr(size_type index) const
+{
+    return (d_data + index);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::get_ref(size_type index)
+{
+    return *get_ptr(index);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::const_reference vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::get_ref(size_type index) const
+{
+    return *get_ptr(index);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class... Args>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::construct(size_type index, Args &&... args)
+{
+    alloc_traits::construct(this->get_alloc(), get_ptr(index), std::forward<Args>(args)...);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::destroy(size_type index)
+{
+    alloc_traits::destroy(this->get_alloc(), get_ptr(index));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::size_type vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::grow_capacity(size_type n) const
+{
+    check_length(n);
+
+    size_type const next = GrowthPolicy::next_capacity(capacity(), n, is_array_used(), sizeof(T));
+
+    return std::max(n, std::min(next, max_size()));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::check_length(size_type n) const
+{
+    // the size and capacity are stored as SizeType
+    if (n > max_size())
+    {
+        throw std::length_error("vector_short_opt");
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::move_to_heap(size_type capacity)
+{
+    pointer const ptr = alloc_traits::allocate(this->get_alloc(), capacity);
+
+    try
+    {
+        (void) detail::relocate_elements(this->get_alloc(), get_ptr(0), get_ptr(d_size), ptr);
+    }
+    catch (...)
+    {
+        alloc_traits::deallocate(this->get_alloc(), ptr, capacity);
+
+        throw;
+    }
+
+    record_spill();
+    deallocate();
+
+    d_data = ptr;
+    d_capacity = capacity;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::move_to_array()
+{
+    // expects the elements on the heap and to fit the inline buffer, which overlaps the capacity
+    pointer const data = d_data;
+    size_type const capacity = d_capacity;
+
+    d_data = get_array_ptr();
+
+    try
+    {
+        (void) detail::relocate_elements(this->get_alloc(), data, data + d_size, d_data);
+    }
+    catch (...)
+    {
+        d_data = data;
+        d_capacity = capacity;
+
+        throw;
+    }
+
+    alloc_traits::deallocate(this->get_alloc(), data, capacity);
+
+    record_shrink();
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::reserve_for_append(size_type n)
+{
+    if (d_size + n > capacity())
+    {
+        move_to_heap(grow_capacity(d_size + n));
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::default_init_back(size_type n, std::true_type)
+{
+    d_size += n;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::default_init_back(size_type n, std::false_type)
+{
+    for (size_type const end = d_size + n; d_size != end; ++d_size)
+    {
+        construct(d_size);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::shrink_if_low()
+{
+    // only done where it cannot throw, so that shrinking operations keep their guarantees
+    shrink_if_low(std::integral_constant<bool, is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value>());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::shrink_if_low(std::true_type)
+{
+    if (!is_array_used() && d_size <= N && ShrinkPolicy::should_shrink(d_size))
+    {
+        move_to_array();
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::shrink_if_low(std::false_type)
+{
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::move_from(vector_short_opt & other)
+{
+    // expects this to be empty; other is left empty and back in its inline buffer
+    if (other.is_array_used())
+    {
+        for (; d_size < other.d_size; ++d_size)
+        {
+            construct(d_size, std::move(*other.get_ptr(d_size)));
+        }
+
+        other.clear();
+    }
+    else
+    {
+        d_data = other.d_data;
+        d_size = other.d_size;
+        d_capacity = other.d_capacity;
+
+        other.d_data = other.get_array_ptr();
+        other.d_size = 0;
+    }
+
+    take_peak(other);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class InputIterator>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::assign_range(InputIterator first, InputIterator last, std::true_type)
+{
+    // assign(3, 7) and vector_short_opt(3, 7) deduce InputIterator as int, which means the fill versions
+    assign(static_cast<size_type>(first), static_cast<value_type>(last));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
 template <class InputIterator>
-inline void vector_short_opt<T, N>::assign(InputIterator first, InputIterator last)
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::assign_range(InputIterator first, InputIterator last, std::false_type)
+{
+    assign_range(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class InputIterator>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::assign_range(InputIterator first, InputIterator last, std::input_iterator_tag)
 {
     clear();
 
-    for (InputIterator i = first; i != last; ++i)
+    for (; first != last; ++first)
+    {
+        (void) emplace_back(*first);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class ForwardIterator>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::assign_range(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+{
+    // measuring the range first means at most one allocation
+    assign_sized(first, last, static_cast<size_type>(std::distance(first, last)));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class ForwardIterator>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::assign_sized(ForwardIterator first, ForwardIterator last, size_type n)
+{
+    record_peak();
+
+    if (n <= N && !is_array_used())
+    {
+        // back to the inline buffer, which overlaps nothing but the saved capacity
+        pointer const data = d_data;
+        size_type const capacity = d_capacity;
+
+        d_data = get_array_ptr();
+
+        try
+        {
+            (void) detail::uninitialized_copy_a(this->get_alloc(), first, last, d_data);
+        }
+        catch (...)
+        {
+            d_data = data;
+            d_capacity = capacity;
+
+            throw;
+        }
+
+        detail::destroy_elements(this->get_alloc(), data, data + d_size);
+        alloc_traits::deallocate(this->get_alloc(), data, capacity);
+
+        d_size = n;
+
+        record_shrink();
+    }
+    else if (n <= capacity())
+    {
+        detail::assign_in_place(this->get_alloc(), get_ptr(0), d_size, first, last, n);
+    }
+    else
+    {
+        check_length(n);
+
+        pointer const ptr = alloc_traits::allocate(this->get_alloc(), n);
+
+        try
+        {
+            (void) detail::uninitialized_copy_a(this->get_alloc(), first, last, ptr);
+        }
+        catch (...)
+        {
+            alloc_traits::deallocate(this->get_alloc(), ptr, n);
+
+            throw;
+        }
+
+        clear();
+        record_spill();
+        deallocate();
+
+        d_data = ptr;
+        d_size = n;
+        d_capacity = n;
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::swap_heap_with_array(vector_short_opt & other)
+{
+    // expects this on the heap and other in its inline buffer; the heap block changes hands
+    pointer const data = d_data;
+    size_type const capacity = d_capacity;
+
+    d_data = get_array_ptr();
+
+    try
+    {
+        (void) detail::relocate_elements(this->get_alloc(), other.get_ptr(0), other.get_ptr(other.d_size), d_data);
+    }
+    catch (...)
+    {
+        d_data = data;
+        d_capacity = capacity;
+
+        throw;
+    }
+
+    other.d_data = data;
+    other.d_capacity = capacity;
+
+    std::swap(d_size, other.d_size);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::swap_arrays(vector_short_opt & other)
+{
+    // expects both in their inline buffers
+    detail::swap_elements(this->get_alloc(), get_ptr(0), d_size, other.get_ptr(0), other.d_size);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class InputIterator>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::insert_range(size_type index, InputIterator first, InputIterator last, std::true_type)
+{
+    // insert(position, 3, 7) deduces InputIterator as int, which means the fill insert
+    insert(iterator(get_ptr(index)), static_cast<size_type>(first), static_cast<value_type>(last));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class InputIterator>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::insert_range(size_type index, InputIterator first, InputIterator last, std::false_type)
+{
+    insert_range(index, first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class InputIterator>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::insert_range(size_type index, InputIterator first, InputIterator last, std::input_iterator_tag)
+{
+    // the length is unknown up front, so append and rotate the new elements into place
+    size_type const old_size = d_size;
+
+    for (; first != last; ++first)
+    {
+        (void) emplace_back(*first);
+    }
+
+    (void) std::rotate(get_ptr(index), get_ptr(old_size), get_ptr(d_size));
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+template <class ForwardIterator>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::insert_range(size_type index, ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+{
+    size_type const count = static_cast<size_type>(std::distance(first, last));
+
+    if (count == 0)
+    {
+        // do nothing
+    }
+    else if (d_size + count <= capacity())
+    {
+        detail::insert_range_in_place(this->get_alloc(), get_ptr(0), d_size, index, first, last, count);
+    }
+    else
+    {
+        size_type const capacity = grow_capacity(d_size + count);
+        pointer const ptr = alloc_traits::allocate(this->get_alloc(), capacity);
+
+        try
+        {
+            (void) detail::uninitialized_copy_a(this->get_alloc(), first, last, ptr + index);
+        }
+        catch (...)
+        {
+            alloc_traits::deallocate(this->get_alloc(), ptr, capacity);
+
+            throw;
+        }
+
+        try
+        {
+            detail::relocate_with_gap(this->get_alloc(), get_ptr(0), d_size, ptr, index, count);
+        }
+        catch (...)
+        {
+            detail::destroy_elements(this->get_alloc(), ptr + index, ptr + index + count);
+            alloc_traits::deallocate(this->get_alloc(), ptr, capacity);
+
+            throw;
+        }
+
+        record_spill();
+        deallocate();
+
+        d_data = ptr;
+        d_size += count;
+        d_capacity = capacity;
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::erase_shifted(size_type index, size_type count)
+{
+    record_peak();
+
+    detail::erase_shifted(this->get_alloc(), get_ptr(0), d_size, index, count);
+
+    shrink_if_low();
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline typename vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::pointer vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::get_array_ptr()
+{
+    return reinterpret_cast<pointer>(d_array);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline bool vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::is_array_used() const
+{
+    return d_data == reinterpret_cast<const_pointer>(d_array);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::destroy_array()
+{
+    for (size_type i = 0; i < d_size; ++i)
     {
-        push_back(*i);
+        destroy(i);
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::assign(size_type n, value_type const & val)
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::deallocate()
 {
-    if (d_array_used)
+    if (!is_array_used())
     {
-        destroy_array();
+        alloc_traits::deallocate(this->get_alloc(), d_data, d_capacity);
     }
-
-    if (n <= N)
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::record_peak()
+{
+    // called before the size goes down, so that the largest one is not missed
+#ifdef OPT_VSO_STATS
+    if (d_size > d_peak)
     {
-        d_array_used = true;
-
-        for (d_size = 0; d_size < n; ++d_size)
-        {
-            construct(d_size, val);
-        }
+        d_peak = d_size;
     }
-    else
+#endif
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::record_spill()
+{
+    // called before a new heap block replaces the current storage
+#ifdef OPT_VSO_STATS
+    if (is_array_used())
     {
-        d_array_used = false;
-        d_vector.assign(n, val);
+        detail::stats_add(detail::stats_local(*d_site).spills, 1);
     }
+#endif
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::push_back(value_type const & val)
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::record_shrink()
 {
-    if (d_array_used)
-    {
-        if (d_size < N)
-        {
-            construct(d_size, val);
-
-            ++d_size;
-        }
-        else
-        {
-            d_vector.reserve(N + 1);
+#ifdef OPT_VSO_STATS
+    detail::stats_add(detail::stats_local(*d_site).shrinks, 1);
+#endif
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::record_destruction()
+{
+#ifdef OPT_VSO_STATS
+    record_peak();
 
-            move_array_to_vector();
+    detail::stats_counters & counters = detail::stats_local(*d_site);
 
-            d_vector.push_back(val);
+    detail::stats_add(counters.objects, 1);
+    detail::stats_add(counters.wasted_bytes, (capacity() - d_size) * sizeof(T));
+    detail::stats_add(counters.peaks[detail::stats_bucket(d_peak)], 1);
+#endif
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType>::take_peak(vector_short_opt & other)
+{
+    // the history goes along with the elements, so that a vector returned by value is counted once
+#ifdef OPT_VSO_STATS
+    record_peak();
 
-            d_array_used = false;
-        }
-    }
-    else
+    if (other.d_peak > d_peak)
     {
-        d_vector.push_back(val);
+        d_peak = other.d_peak;
     }
+
+    other.d_peak = 0;
+#else
+    (void) other;
+#endif
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, std::size_t N, typename Alloc, std::size_t Align, typename ShrinkPolicy, typename GrowthPolicy, typename SizeType>
+inline void swap(vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType> & lhs, vector_short_opt<T, N, Alloc, Align, ShrinkPolicy, GrowthPolicy, SizeType> & rhs) noexcept(noexcept(lhs.swap(rhs)))
+{
+    lhs.swap(rhs);
+}
+////////////////////////////////////////////////////////////////////////////////
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic pop
+#endif
+
+namespace opt
+{
+////////////////////////////////////////////////////////////////////////////////
+inline bool shrink_never::should_shrink(std::size_t size)
+{
+    (void) size;
+
+    return false;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<std::size_t LowWater>
+inline bool shrink_below<LowWater>::should_shrink(std::size_t size)
+{
+    return size <= LowWater;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<std::size_t Num, std::size_t Den>
+inline std::size_t grow_by<Num, Den>::next_capacity(std::size_t capacity, std::size_t n, bool spilling, std::size_t element_size)
+{
+    (void) n;
+    (void) spilling;
+    (void) element_size;
+
+    return capacity * Num / Den;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::size_t grow_first_spill_2n::next_capacity(std::size_t capacity, std::size_t n, bool spilling, std::size_t element_size)
+{
+    (void) n;
+    (void) element_size;
+
+    return spilling
+        ? 2 * capacity
+        : capacity + capacity / 2;
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::pop_back()
+inline std::size_t grow_size_class::next_capacity(std::size_t capacity, std::size_t n, bool spilling, std::size_t element_size)
 {
-    if (d_array_used)
+    (void) spilling;
+
+    std::size_t const bytes = std::max(n, 2 * capacity) * element_size;
+    std::size_t block = 16;
+
+    while (block < bytes && block * 2 > block)
     {
-        destroy(--d_size);
+        block *= 2;
     }
-    else
+
+    return block / element_size;
+}
+////////////////////////////////////////////////////////////////////////////////
+}
+
+
+namespace opt
+{
+namespace detail
+{
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc>
+inline allocator_holder<Alloc>::allocator_holder(Alloc const & alloc)
+    : Alloc(alloc)
+{
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc>
+inline Alloc & allocator_holder<Alloc>::get_alloc()
+{
+    return *this;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc>
+inline Alloc const & allocator_holder<Alloc>::get_alloc() const
+{
+    return *this;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc>
+inline void assign_allocator(Alloc & to, Alloc const & from, std::true_type)
+{
+    to = from;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc>
+inline void assign_allocator(Alloc & to, Alloc const & from, std::false_type)
+{
+    (void) to;
+    (void) from;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc>
+inline void swap_allocators(Alloc & lhs, Alloc & rhs, std::true_type)
+{
+    using std::swap;
+
+    swap(lhs, rhs);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc>
+inline void swap_allocators(Alloc & lhs, Alloc & rhs, std::false_type)
+{
+    (void) lhs;
+    (void) rhs;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T>
+inline void destroy_elements(Alloc & alloc, T * first, T * last)
+{
+    for (; first != last; ++first)
     {
-        d_vector.pop_back();
+        std::allocator_traits<Alloc>::destroy(alloc, first);
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::iterator vector_short_opt<T, N>::insert(iterator position, value_type const & val)
+template<typename Alloc, typename InputIterator, typename T>
+inline T * uninitialized_copy_a(Alloc & alloc, InputIterator first, InputIterator last, T * dest)
 {
-    iterator result;
+    T * current = dest;
 
-    if (d_array_used)
+    try
     {
-        if (d_size < N)
+        for (; first != last; ++first, ++current)
         {
-            if (position == end())
-            {
-                construct(d_size++, val);
-
-                result = position;
-            }
-            else
-            {
-                construct(d_size, *get_ptr(d_size - 1));
-                std::copy_backward(position, iterator(get_ptr(d_size - 1)), iterator(get_ptr(d_size)));
-                ++d_size;
-                *position = val;
-                result = position;
-            }
+            std::allocator_traits<Alloc>::construct(alloc, current, *first);
         }
-        else
-        {
-            d_vector.reserve(N + 1);
+    }
+    catch (...)
+    {
+        destroy_elements(alloc, dest, current);
 
-            move_array_to_vector();
+        throw;
+    }
 
-            result = iterator(&*d_vector.insert(d_vector.begin() + (position - iterator(get_ptr(0))), val));
+    return current;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T>
+inline T * uninitialized_fill_n_a(Alloc & alloc, T * dest, std::size_t n, T const & val)
+{
+    T * current = dest;
 
-            d_array_used = false;
+    try
+    {
+        for (; n > 0; --n, ++current)
+        {
+            std::allocator_traits<Alloc>::construct(alloc, current, val);
         }
     }
-    else
+    catch (...)
     {
-        result = iterator(&*d_vector.insert(d_vector.begin() + std::distance(begin(), position), val));
+        destroy_elements(alloc, dest, current);
+
+        throw;
     }
 
-    return result;
+    return current;
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::insert(iterator position, size_type n, value_type const & val)
+template<typename Alloc, typename T>
+inline T * uninitialized_move_if_noexcept(Alloc & alloc, T * first, T * last, T * dest)
 {
-    if (d_array_used)
-    {
-        if (d_size + n <= N)
-        {
-            while (n-- > 0)
-            {
-                position = insert(position, val);
-                ++position;
-            }
-        }
-        else
-        {
-            d_vector.reserve(d_size + n);
+    // a throwing move would leave the source half moved-from, so such types get copied
+    // to keep the strong guarantee, unless they cannot be copied at all
+    typedef std::integral_constant<bool, std::is_nothrow_move_constructible<T>::value || !std::is_copy_constructible<T>::value> use_move;
+
+    return uninitialized_move_if_noexcept(alloc, first, last, dest, use_move());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T>
+inline T * uninitialized_move_if_noexcept(Alloc & alloc, T * first, T * last, T * dest, std::true_type)
+{
+    return uninitialized_copy_a(alloc, std::make_move_iterator(first), std::make_move_iterator(last), dest);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T>
+inline T * uninitialized_move_if_noexcept(Alloc & alloc, T * first, T * last, T * dest, std::false_type)
+{
+    return uninitialized_copy_a(alloc, first, last, dest);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T>
+inline T * copy_elements(Alloc & alloc, T const * first, T const * last, T * dest)
+{
+    return copy_elements(alloc, first, last, dest, typename std::is_trivially_copyable<T>::type());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T>
+inline T * copy_elements(Alloc & alloc, T const * first, T const * last, T * dest, std::true_type)
+{
+    std::size_t const count = last - first;
+
+    (void) alloc;
+    (void) std::memcpy(static_cast<void *>(dest), static_cast<void const *>(first), count * sizeof(T));
+
+    return dest + count;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T>
+inline T * copy_elements(Alloc & alloc, T const * first, T const * last, T * dest, std::false_type)
+{
+    return uninitialized_copy_a(alloc, first, last, dest);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T>
+inline T * relocate_elements(Alloc & alloc, T * first, T * last, T * dest)
+{
+    // moves the elements into raw storage and ends their lifetime at the source
+    return relocate_elements(alloc, first, last, dest, typename is_trivially_relocatable<T>::type());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T>
+inline T * relocate_elements(Alloc & alloc, T * first, T * last, T * dest, std::true_type)
+{
+    std::size_t const count = last - first;
+
+    (void) alloc;
+    (void) std::memcpy(static_cast<void *>(dest), static_cast<void const *>(first), count * sizeof(T));
 
-            move_array_to_vector();
+    return dest + count;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T>
+inline T * relocate_elements(Alloc & alloc, T * first, T * last, T * dest, std::false_type)
+{
+    T * const result = uninitialized_move_if_noexcept(alloc, first, last, dest);
 
-            d_vector.insert(d_vector.begin() + (position - iterator(get_ptr(0))), n, val);
+    destroy_elements(alloc, first, last);
 
-            d_array_used = false;
-        }
+    return result;
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename Alloc>
+template<typename... Args>
+inline temporary_value<T, Alloc>::temporary_value(Alloc & alloc, Args &&... args)
+    : d_alloc(alloc)
+{
+    std::allocator_traits<Alloc>::construct(d_alloc, &get(), std::forward<Args>(args)...);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename Alloc>
+inline temporary_value<T, Alloc>::~temporary_value()
+{
+    std::allocator_traits<Alloc>::destroy(d_alloc, &get());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename Alloc>
+inline T & temporary_value<T, Alloc>::get()
+{
+    return *reinterpret_cast<T *>(d_storage);
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T, typename SizeType, typename ForwardIterator>
+inline void insert_range_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, ForwardIterator first, ForwardIterator last, std::size_t count)
+{
+    // expects room for count more elements; the range must not refer to the elements
+    insert_range_in_place(alloc, data, size, index, first, last, count, typename is_trivially_relocatable<T>::type());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T, typename SizeType, typename ForwardIterator>
+inline void insert_range_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, ForwardIterator first, ForwardIterator last, std::size_t count, std::true_type)
+{
+    std::size_t const tail = size - index;
+
+    (void) std::memmove(static_cast<void *>(data + index + count), static_cast<void const *>(data + index), tail * sizeof(T));
+
+    try
+    {
+        (void) uninitialized_copy_a(alloc, first, last, data + index);
     }
-    else
+    catch (...)
     {
-        d_vector.insert(d_vector.begin() + std::distance(begin(), position), n, val);
+        (void) std::memmove(static_cast<void *>(data + index), static_cast<void const *>(data + index + count), tail * sizeof(T));
+
+        throw;
     }
+
+    size += count;
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-template <class InputIterator>
-inline void vector_short_opt<T, N>::insert(iterator position, InputIterator first, InputIterator last)
+template<typename Alloc, typename T, typename SizeType, typename ForwardIterator>
+inline void insert_range_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, ForwardIterator first, ForwardIterator last, std::size_t count, std::false_type)
 {
-    if (d_array_used)
+    // the tail is shifted once: its end goes to raw storage, the rest is assigned over
+    std::size_t const old_size = size;
+    std::size_t const tail = old_size - index;
+
+    if (tail > count)
     {
-        while (first != last)
-        {
-            position = insert(position, *first);
-            ++position;
-        }
+        (void) uninitialized_copy_a(alloc, std::make_move_iterator(data + old_size - count), std::make_move_iterator(data + old_size), data + old_size);
+        size += count;
+
+        (void) std::move_backward(data + index, data + old_size - count, data + old_size);
+        (void) std::copy(first, last, data + index);
     }
     else
     {
-        d_vector.insert(d_vector.begin() + std::distance(begin(), position), first, last);
+        ForwardIterator middle = first;
+        std::advance(middle, tail);
+
+        (void) uninitialized_copy_a(alloc, middle, last, data + old_size);
+        size += count - tail;
+
+        (void) uninitialized_copy_a(alloc, std::make_move_iterator(data + index), std::make_move_iterator(data + old_size), data + index + count);
+        size += tail;
+
+        (void) std::copy(first, middle, data + index);
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::iterator vector_short_opt<T, N>::erase(iterator position)
+template<typename Alloc, typename T, typename SizeType>
+inline void insert_fill_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count, T const & val)
 {
-    if (d_array_used)
-    {
-        std::copy_backward(position + 1, end(), position);
+    // expects room for count more elements; val is copied first only if it is one of those about to be shifted
+    std::less<T const *> const before;
+    T const * const address = std::addressof(val);
 
-        destroy(d_size--);
+    if (!before(address, data + index) && before(address, data + size))
+    {
+        temporary_value<T, Alloc> copy(alloc, val);
 
-        return position;
+        insert_fill_in_place(alloc, data, size, index, count, copy.get(), typename is_trivially_relocatable<T>::type());
     }
     else
     {
-        typename std::vector<T>::iterator i = d_vector.erase(d_vector.begin() + std::distance(begin(), position));
-
-        return i != d_vector.end()
-            ? iterator(&*i)
-            : end();
+        insert_fill_in_place(alloc, data, size, index, count, val, typename is_trivially_relocatable<T>::type());
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::iterator vector_short_opt<T, N>::erase(iterator first, iterator last)
+template<typename Alloc, typename T, typename SizeType>
+inline void insert_fill_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count, T const & val, std::true_type)
 {
-    if (d_array_used)
-    {
-        iterator i = first;
-        while (i != last)
-        {
-            erase(i);
-        }
+    std::size_t const tail = size - index;
+
+    (void) std::memmove(static_cast<void *>(data + index + count), static_cast<void const *>(data + index), tail * sizeof(T));
 
-        return first;
+    try
+    {
+        (void) uninitialized_fill_n_a(alloc, data + index, count, val);
     }
-    else
+    catch (...)
     {
-        typename std::vector<T>::iterator i = d_vector.erase(d_vector.begin() + std::distance(begin(), first), d_vector.begin() + std::distance(begin(), last));
+        (void) std::memmove(static_cast<void *>(data + index), static_cast<void const *>(data + index + count), tail * sizeof(T));
 
-        return i != d_vector.end()
-            ? iterator(&*i)
-            : end();
+        throw;
     }
+
+    size += count;
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::clear()
+template<typename Alloc, typename T, typename SizeType>
+inline void insert_fill_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count, T const & val, std::false_type)
 {
-    if (d_array_used)
+    std::size_t const old_size = size;
+    std::size_t const tail = old_size - index;
+
+    if (tail > count)
     {
-        destroy_array();
+        (void) uninitialized_copy_a(alloc, std::make_move_iterator(data + old_size - count), std::make_move_iterator(data + old_size), data + old_size);
+        size += count;
 
-        d_size = 0;
+        (void) std::move_backward(data + index, data + old_size - count, data + old_size);
+        std::fill(data + index, data + index + count, val);
     }
     else
     {
-        d_vector.clear();
+        (void) uninitialized_fill_n_a(alloc, data + old_size, count - tail, val);
+        size += count - tail;
+
+        (void) uninitialized_copy_a(alloc, std::make_move_iterator(data + index), std::make_move_iterator(data + old_size), data + index + count);
+        size += tail;
+
+        std::fill(data + index, data + old_size, val);
     }
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline bool vector_short_opt<T, N>::empty() const
+template<typename Alloc, typename T, typename SizeType>
+inline void insert_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, T && val)
+{
+    // expects index < size and room for one more element; val must not be one of the elements
+    insert_shifted(alloc, data, size, index, std::move(val), typename is_trivially_relocatable<T>::type());
+}
+////////////////////////////////////////////////////////////////////////////////
+template<typename Alloc, typename T, typename SizeType>
+inline void insert_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, T && val, std::true_type)
 {
-    return d_array_used
-        ? d_size == 0
-        : d_vector.empty();
+    std::size_t const count = size - index;
+
+    (void) std::memmove(static_cast<void *>(data + index + 1), static_cast<void const *>(data + index), count * sizeof(T));
+
+    try
+    {
+        std::allocator_traits<Alloc>::construct(alloc, data + index, std::move(val));
+    }
+    catch (...)
+    {
+        (void) std::memmove(static_cast<void *>(data + index), static_cast<void const *>(data + index + 1), count * sizeof(T));
+
+        throw;
+    }
+
+    ++size;
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::size_type vector_short_opt<T, N>::size() const
+template<typename Alloc, typename T, typename SizeType>
+inline void insert_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, T && val, std::false_type)
 {
-    return d_array_used
-        ? d_size
-        : d_vector.size();
+    std::allocator_traits<Alloc>::construct(alloc, data + size, std::move(data[size - 1]));
+    ++size;
+
+    (void) std::move_backward(data + index, data + size - 2, data + size - 1);
+    data[index] = std::move(val);
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::size_type vector_short_opt<T, N>::capacity() const
+template<typename Alloc, typename T, typename SizeType>
+inline void erase_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count)
 {
-    return d_array_used
-        ? N
-        : d_vector.capacity();
+    // the tail moves down once, whatever the count
+    erase_shifted(alloc, data, size, index, count, typename is_trivially_relocatable<T>::type());
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::size_type vector_short_opt<T, N>::max_size() const
+template<typename Alloc, typename T, typename SizeType>
+inline void erase_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count, std::true_type)
 {
-    return d_vector.max_size();
+    destroy_elements(alloc, data + index, data + index + count);
+
+    (void) std::memmove(static_cast<void *>(data + index), static_cast<void const *>(data + index + count), (size - index - count) * sizeof(T));
+
+    size -= count;
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::allocator_type vector_short_opt<T, N>::get_allocator() const
+template<typename Alloc, typename T, typename SizeType>
+inline void erase_shifted(Alloc & alloc, T * data, SizeType & size, std::size_t index, std::size_t count, std::false_type)
 {
-    return d_vector.get_allocator();
+    (void) std::move(data + index + count, data + size, data + index);
+
+    destroy_elements(alloc, data + size - count, data + size);
+
+    size -= count;
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::pointer vector_short_opt<T, N>::get_ptr(size_type index)
+template<typename Alloc, typename T, typename SizeType, typename ForwardIterator>
+inline void assign_in_place(Alloc & alloc, T * data, SizeType & size, ForwardIterator first, ForwardIterator last, std::size_t n)
 {
-    pointer p = reinterpret_cast<pointer>(d_array);
+    // expects room for n elements; assigns over the live prefix, then constructs or destroys the difference
+    std::size_t const common = std::min<std::size_t>(n, size);
+    ForwardIterator middle = first;
+    std::advance(middle, common);
+
+    (void) std::copy(first, middle, data);
+
+    if (n > size)
+    {
+        (void) uninitialized_copy_a(alloc, middle, last, data + size);
+    }
+    else
+    {
+        destroy_elements(alloc, data + n, data + size);
+    }
 
-    return (p + index);
+    size = static_cast<SizeType>(n);
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::const_pointer vector_short_opt<T, N>::get_ptr(size_type index) const
+template<typename Alloc, typename T, typename SizeType>
+inline void assign_fill_in_place(Alloc & alloc, T * data, SizeType & size, std::size_t n, T const & val)
 {
-    const_pointer p = reinterpret_cast<const_pointer>(d_array);
+    // val may be one of the elements: it is at worst assigned to itself, and destroyed after its last use
+    std::size_t const common = std::min<std::size_t>(n, size);
+
+    std::fill(data, data + common, val);
+
+    if (n > size)
+    {
+        (void) uninitialized_fill_n_a(alloc, data + size, n - size, val);
+    }
+    else
+    {
+        destroy_elements(alloc, data + n, data + size);
+    }
 
-    return (p + index);
+    size = static_cast<SizeType>(n);
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::reference vector_short_opt<T, N>::get_ref(size_type index)
+template<typename Alloc, typename T>
+inline void relocate_with_gap(Alloc & alloc, T * data, std::size_t size, T * dest, std::size_t index, std::size_t count)
 {
-    return *get_ptr(index);
+    // moves the elements to dest, leaving count uninitialised slots at index
+    relocate_with_gap(alloc, data, size, dest, index, count, typename is_trivially_relocatable<T>::type());
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline typename vector_short_opt<T, N>::const_reference vector_short_opt<T, N>::get_ref(size_type index) const
+template<typename Alloc, typename T>
+inline void relocate_with_gap(Alloc & alloc, T * data, std::size_t size, T * dest, std::size_t index, std::size_t count, std::true_type)
 {
-    return *get_ptr(index);
+    (void) relocate_elements(alloc, data, data + index, dest);
+    (void) relocate_elements(alloc, data + index, data + size, dest + index + count);
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::construct(size_type index, value_type const & val)
+template<typename Alloc, typename T>
+inline void relocate_with_gap(Alloc & alloc, T * data, std::size_t size, T * dest, std::size_t index, std::size_t count, std::false_type)
 {
-    (void) new(get_ptr(index)) T(val);
+    // nothing is destroyed until both parts made it, so a throwing copy leaves the source intact
+    (void) uninitialized_move_if_noexcept(alloc, data, data + index, dest);
+
+    try
+    {
+        (void) uninitialized_move_if_noexcept(alloc, data + index, data + size, dest + index + count);
+    }
+    catch (...)
+    {
+        destroy_elements(alloc, dest, dest + index);
+
+        throw;
+    }
+
+    destroy_elements(alloc, data, data + size);
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::destroy(size_type index)
+template<typename Alloc, typename T, typename SizeType>
+inline void swap_elements(Alloc & alloc, T * lhs, SizeType & lhs_size, T * rhs, SizeType & rhs_size)
 {
-    get_ptr(index)->~T();
+    // both sides must have room for the longer one
+    swap_elements(alloc, lhs, lhs_size, rhs, rhs_size, typename is_trivially_relocatable<T>::type());
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::move_array_to_vector()
+template<typename Alloc, typename T, typename SizeType>
+inline void swap_elements(Alloc &, T * lhs, SizeType & lhs_size, T * rhs, SizeType & rhs_size, std::true_type)
 {
-    d_vector.assign(get_ptr(0), get_ptr(d_size));
+    std::size_t const count = std::max(lhs_size, rhs_size);
 
-    destroy_array();
+    (void) std::swap_ranges(reinterpret_cast<unsigned char *>(lhs), reinterpret_cast<unsigned char *>(lhs + count), reinterpret_cast<unsigned char *>(rhs));
+
+    std::swap(lhs_size, rhs_size);
 }
 ////////////////////////////////////////////////////////////////////////////////
-template<typename T, std::size_t N>
-inline void vector_short_opt<T, N>::destroy_array()
+template<typename Alloc, typename T, typename SizeType>
+inline void swap_elements(Alloc & alloc, T * lhs, SizeType & lhs_size, T * rhs, SizeType & rhs_size, std::false_type)
 {
-    for (size_type i = 0; i < d_size; ++i)
+    // the common prefix is swapped, the rest of the longer side is moved over
+    bool const lhs_shorter = lhs_size < rhs_size;
+    T * const shorter = lhs_shorter ? lhs : rhs;
+    T * const longer = lhs_shorter ? rhs : lhs;
+    SizeType & shorter_size = lhs_shorter ? lhs_size : rhs_size;
+    SizeType & longer_size = lhs_shorter ? rhs_size : lhs_size;
+    std::size_t const common = shorter_size;
+
+    using std::swap;
+
+    for (std::size_t i = 0; i < common; ++i)
     {
-        destroy(i);
+        swap(shorter[i], longer[i]);
+    }
+
+    for (; shorter_size < longer_size; ++shorter_size)
+    {
+        std::allocator_traits<Alloc>::construct(alloc, shorter + shorter_size, std::move(longer[shorter_size]));
     }
+
+    destroy_elements(alloc, longer + common, longer + longer_size);
+
+    longer_size = static_cast<SizeType>(common);
 }
 ////////////////////////////////////////////////////////////////////////////////
 }
+}
 
 namespace opt
 {
@@ -1263,4 +2820,471 @@ inline typename const_iterator<T>::difference_type operator-(const_iterator<T> c
 }
 }
 
+#ifdef OPT_VSO_STATS
+namespace opt
+{
+namespace detail
+{
+////////////////////////////////////////////////////////////////////////////////
+inline std::size_t stats_bucket(std::uint64_t size)
+{
+    if (size < stats_exact)
+    {
+        return static_cast<std::size_t>(size);
+    }
+
+    std::size_t bucket = stats_exact;
+
+    for (size >>= 7; size != 0; size >>= 1)
+    {
+        ++bucket;
+    }
+
+    return bucket;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::uint64_t stats_bucket_min(std::size_t bucket)
+{
+    return bucket < stats_exact
+        ? bucket
+        : std::uint64_t(stats_exact) << (bucket - stats_exact);
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::uint64_t stats_bucket_max(std::size_t bucket)
+{
+    return bucket + 1 < stats_buckets
+        ? stats_bucket_min(bucket + 1) - 1
+        : static_cast<std::uint64_t>(-1);
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_totals::stats_totals()
+    : objects(0)
+    , spills(0)
+    , shrinks(0)
+    , wasted_bytes(0)
+{
+    for (std::size_t i = 0; i < stats_buckets; ++i)
+    {
+        peaks[i] = 0;
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_counters::stats_counters()
+    : objects(0)
+    , spills(0)
+    , shrinks(0)
+    , wasted_bytes(0)
+{
+    for (std::size_t i = 0; i < stats_buckets; ++i)
+    {
+        peaks[i].store(0, std::memory_order_relaxed);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void stats_counters::add_to(stats_totals & totals) const
+{
+    totals.objects += objects.load(std::memory_order_relaxed);
+    totals.spills += spills.load(std::memory_order_relaxed);
+    totals.shrinks += shrinks.load(std::memory_order_relaxed);
+    totals.wasted_bytes += wasted_bytes.load(std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < stats_buckets; ++i)
+    {
+        totals.peaks[i] += peaks[i].load(std::memory_order_relaxed);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void stats_add(std::atomic<std::uint64_t> & counter, std::uint64_t n)
+{
+    // uncontended but for the shared counters, so this stays cheap
+    (void) counter.fetch_add(n, std::memory_order_relaxed);
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_location stats_location::current(char const * file, unsigned line) noexcept
+{
+    stats_location const location = {file, line};
+
+    return location;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_site::stats_site(std::type_info const & type, std::size_t inline_capacity, std::size_t element_size, std::size_t alignment, stats_location location)
+    : d_type(type)
+    , d_name(stats_type_name(type))
+    , d_file(location.file)
+    , d_line(location.line)
+    , d_inline_capacity(inline_capacity)
+    , d_element_size(element_size)
+    , d_alignment(alignment)
+{
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void stats_site::attach(stats_counters const * counters)
+{
+    std::lock_guard<std::mutex> const lock(d_mutex);
+
+    d_live.push_back(counters);
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void stats_site::detach(stats_counters const * counters)
+{
+    std::lock_guard<std::mutex> const lock(d_mutex);
+
+    counters->add_to(d_retired);
+
+    d_live.erase(std::find(d_live.begin(), d_live.end(), counters));
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_counters & stats_site::shared()
+{
+    return d_shared;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline bool stats_site::is_at(std::type_info const & type, stats_location location) const
+{
+    return d_type == type && d_line == location.line && d_file == location.file;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::string const & stats_site::name() const
+{
+    return d_name;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::string const & stats_site::file() const
+{
+    return d_file;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline unsigned stats_site::line() const
+{
+    return d_line;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::size_t stats_site::inline_capacity() const
+{
+    return d_inline_capacity;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::size_t stats_site::element_size() const
+{
+    return d_element_size;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::size_t stats_site::alignment() const
+{
+    return d_alignment;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_totals stats_site::totals() const
+{
+    std::lock_guard<std::mutex> const lock(d_mutex);
+
+    stats_totals totals = d_retired;
+
+    d_shared.add_to(totals);
+
+    for (std::size_t i = 0; i < d_live.size(); ++i)
+    {
+        d_live[i]->add_to(totals);
+    }
+
+    return totals;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline bool stats_key::operator<(stats_key const & rhs) const
+{
+    std::less<void const *> const less;
+
+    if (type != rhs.type)
+    {
+        return less(type, rhs.type);
+    }
+    else if (file != rhs.file)
+    {
+        return less(file, rhs.file);
+    }
+    else
+    {
+        return line < rhs.line;
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_thread::stats_thread(bool & finished)
+    : d_finished(finished)
+{
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_thread::~stats_thread()
+{
+    for (std::map<stats_site *, stats_counters *>::iterator i = d_counters.begin(); i != d_counters.end(); ++i)
+    {
+        i->first->detach(i->second);
+
+        delete i->second;
+    }
+
+    d_finished = true;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_site * stats_thread::find(stats_key const & key) const
+{
+    std::map<stats_key, stats_site *>::const_iterator const i = d_sites.find(key);
+
+    return i != d_sites.end() ? i->second : NULL;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void stats_thread::add(stats_key const & key, stats_site * site)
+{
+    d_sites[key] = site;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_counters & stats_thread::counters(stats_site & site)
+{
+    stats_counters * & counters = d_counters[&site];
+
+    if (counters == NULL)
+    {
+        counters = new stats_counters;
+
+        site.attach(counters);
+    }
+
+    return *counters;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::mutex & stats_mutex()
+{
+    static std::mutex * const mutex = new std::mutex;
+
+    return *mutex;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::vector<stats_site *> & stats_sites()
+{
+    static std::vector<stats_site *> * const sites = new std::vector<stats_site *>;
+
+    return *sites;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_site & stats_register(std::type_info const & type, std::size_t inline_capacity, std::size_t element_size, std::size_t alignment, stats_location location)
+{
+    std::lock_guard<std::mutex> const lock(stats_mutex());
+
+    std::vector<stats_site *> & sites = stats_sites();
+
+    for (std::size_t i = 0; i < sites.size(); ++i)
+    {
+        if (sites[i]->is_at(type, location))
+        {
+            return *sites[i];
+        }
+    }
+
+    if (sites.empty())
+    {
+        (void) std::atexit(&stats_at_exit);
+    }
+
+    sites.push_back(new stats_site(type, inline_capacity, element_size, alignment, location));
+
+    return *sites.back();
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void stats_at_exit()
+{
+    char const * const path = std::getenv("OPT_VSO_STATS_FILE");
+
+    if (path == NULL)
+    {
+        return;
+    }
+
+    std::string const name(path);
+    std::ofstream file(path);
+
+    if (name.size() >= 5 && name.compare(name.size() - 5, 5, ".json") == 0)
+    {
+        write_stats_json(file);
+    }
+    else
+    {
+        write_stats_csv(file);
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+inline std::string stats_type_name(std::type_info const & type)
+{
+#if defined(__GNUG__)
+    int status = 0;
+    char * const name = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+
+    if (status == 0)
+    {
+        std::string const result(name);
+
+        std::free(name);
+
+        return result;
+    }
+#endif
+
+    return type.name();
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void stats_write_prefix(std::ostream & os, stats_site const & site, stats_totals const & totals)
+{
+    stats_write_quoted(os, site.name(), '"');
+    os << ',';
+    stats_write_quoted(os, site.file(), '"');
+
+    os << ',' << site.line() << ',' << site.inline_capacity() << ',' << site.element_size() << ',' << site.alignment()
+       << ',' << totals.objects << ',' << totals.spills << ',' << totals.shrinks << ',' << totals.wasted_bytes;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void stats_write_quoted(std::ostream & os, std::string const & str, char escape)
+{
+    os << '"';
+
+    for (std::size_t i = 0; i < str.size(); ++i)
+    {
+        if (str[i] == '"' || str[i] == escape)
+        {
+            os << escape;
+        }
+
+        os << str[i];
+    }
+
+    os << '"';
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_thread * stats_current_thread()
+{
+    // a plain flag outlives the objects of the thread, so that vectors destroyed after them,
+    // e.g. globals at exit, can tell
+    thread_local bool finished = false;
+
+    if (finished)
+    {
+        return NULL;
+    }
+    else
+    {
+        thread_local stats_thread thread(finished);
+
+        return &thread;
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_site & stats_find_site(std::type_info const & type, std::size_t inline_capacity, std::size_t element_size, std::size_t alignment, stats_location location)
+{
+    // the lock is taken once per thread and site, later lookups stay within the thread
+    stats_thread * const thread = stats_current_thread();
+    stats_key const key = {&type, location.file, location.line};
+    stats_site * site = thread != NULL ? thread->find(key) : NULL;
+
+    if (site == NULL)
+    {
+        site = &stats_register(type, inline_capacity, element_size, alignment, location);
+
+        if (thread != NULL)
+        {
+            thread->add(key, site);
+        }
+    }
+
+    return *site;
+}
+////////////////////////////////////////////////////////////////////////////////
+inline stats_counters & stats_local(stats_site & site)
+{
+    stats_thread * const thread = stats_current_thread();
+
+    return thread != NULL ? thread->counters(site) : site.shared();
+}
+////////////////////////////////////////////////////////////////////////////////
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void write_stats_csv(std::ostream & os)
+{
+    // one row per non-empty peak size bucket, or one without a bucket if no object was destroyed yet
+    std::lock_guard<std::mutex> const lock(detail::stats_mutex());
+
+    os << "vector,file,line,inline_capacity,element_size,alignment,objects,spills,shrinks,wasted_bytes,peak_min,peak_max,count\n";
+
+    for (std::size_t s = 0; s < detail::stats_sites().size(); ++s)
+    {
+        detail::stats_site const & site = *detail::stats_sites()[s];
+        detail::stats_totals const totals = site.totals();
+
+        for (std::size_t b = 0; b < detail::stats_buckets; ++b)
+        {
+            if (totals.peaks[b] != 0)
+            {
+                detail::stats_write_prefix(os, site, totals);
+
+                os << ',' << detail::stats_bucket_min(b) << ',' << detail::stats_bucket_max(b) << ',' << totals.peaks[b] << '\n';
+            }
+        }
+
+        if (totals.objects == 0)
+        {
+            detail::stats_write_prefix(os, site, totals);
+
+            os << ",,,0\n";
+        }
+    }
+}
+////////////////////////////////////////////////////////////////////////////////
+inline void write_stats_json(std::ostream & os)
+{
+    std::lock_guard<std::mutex> const lock(detail::stats_mutex());
+
+    os << "[";
+
+    for (std::size_t s = 0; s < detail::stats_sites().size(); ++s)
+    {
+        detail::stats_site const & site = *detail::stats_sites()[s];
+        detail::stats_totals const totals = site.totals();
+
+        os << (s == 0 ? "\n" : ",\n") << "  {\"vector\": ";
+
+        detail::stats_write_quoted(os, site.name(), '\\');
+        os << ", \"file\": ";
+        detail::stats_write_quoted(os, site.file(), '\\');
+
+        os << ", \"line\": " << site.line()
+           << ", \"inline_capacity\": " << site.inline_capacity()
+           << ", \"element_size\": " << site.element_size()
+           << ", \"alignment\": " << site.alignment()
+           << ", \"objects\": " << totals.objects
+           << ", \"spills\": " << totals.spills
+           << ", \"shrinks\": " << totals.shrinks
+           << ", \"wasted_bytes\": " << totals.wasted_bytes
+           << ", \"peak_sizes\": [";
+
+        char const * separator = "";
+
+        for (std::size_t b = 0; b < detail::stats_buckets; ++b)
+        {
+            if (totals.peaks[b] != 0)
+            {
+                os << separator << "{\"min\": " << detail::stats_bucket_min(b) << ", \"max\": " << detail::stats_bucket_max(b) << ", \"count\": " << totals.peaks[b] << "}";
+
+                separator = ", ";
+            }
+        }
+
+        os << "]}";
+    }
+
+    os << "\n]\n";
+}
+////////////////////////////////////////////////////////////////////////////////
+}
+#endif
+
+#undef OPT_VSO_STATS_PARAM
+#undef OPT_VSO_STATS_ARG
+#undef OPT_VSO_STATS_INIT
+
 #endif /* SHORT_VECTOR_OPT_H__DDK */